@@ -9,7 +9,9 @@ SOURCES += \
 	$$PWD/src/DropOverlay.cpp \
 	$$PWD/src/FloatingWidget.cpp \
 	$$PWD/src/Internal.cpp \
-	$$PWD/src/Serialization.cpp
+	$$PWD/src/Serialization.cpp \
+	$$PWD/src/DockLayoutTree.cpp \
+	$$PWD/src/DockLayoutGeometry.cpp
 
 HEADERS += \
 	$$PWD/include/ads/API.h \
@@ -21,4 +23,6 @@ HEADERS += \
 	$$PWD/include/ads/DropOverlay.h \
 	$$PWD/include/ads/FloatingWidget.h \
 	$$PWD/include/ads/Internal.h \
-	$$PWD/include/ads/Serialization.h
+	$$PWD/include/ads/Serialization.h \
+	$$PWD/include/ads/DockLayoutTree.h \
+	$$PWD/include/ads/DockLayoutGeometry.h
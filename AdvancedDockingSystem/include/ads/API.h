@@ -64,7 +64,19 @@ enum DropArea
 };
 Q_DECLARE_FLAGS(DropAreas, DropArea)
 
+/*!
+ * Deletes all splitters of <em>container</em>, which do not contain any SectionWidget.
+ * Runs a single pass over the splitter tree.
+ */
 void deleteEmptySplitter(ContainerWidget* container);
+
+/*!
+ * Deletes <em>splitter</em> if it has no more children and continues with its
+ * parent splitters, as long as they become empty as well.
+ * Costs O(depth), because splitters are never left empty by ADS.
+ */
+void deleteEmptySplitter(QSplitter* splitter);
+
 ContainerWidget* findParentContainerWidget(QWidget* w);
 SectionWidget* findParentSectionWidget(QWidget* w);
 QSplitter* findParentSplitter(QWidget* w);
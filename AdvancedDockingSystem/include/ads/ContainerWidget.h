@@ -3,24 +3,46 @@
 
 #include <QList>
 #include <QHash>
+#include <QVector>
 #include <QPointer>
 #include <QFrame>
+#include <QPalette>
 class QPoint;
 class QSplitter;
 class QMenu;
 class QGridLayout;
+class QTimer;
 
 #include "ads/API.h"
 #include "ads/Internal.h"
 #include "ads/SectionContent.h"
 #include "ads/FloatingWidget.h"
 #include "ads/Serialization.h"
+#include "ads/DockLayoutTree.h"
 
 ADS_NAMESPACE_BEGIN
 class SectionWidget;
 class DropOverlay;
 class InternalContentData;
 
+/*!
+ * Describes how the state of a SectionContent has changed.
+ * \see ContainerWidget::sectionContentsChanged()
+ */
+class ADS_EXPORT_API SectionContentChange
+{
+public:
+	SectionContentChange() :
+		visibleBefore(false), visible(false),
+		activeBefore(false), active(false)
+	{}
+
+	SectionContent::RefPtr content;
+	bool visibleBefore;
+	bool visible;
+	bool activeBefore;
+	bool active;
+};
 
 /*!
  * ContainerWidget is the main container to provide the docking
@@ -37,6 +59,15 @@ class ADS_EXPORT_API ContainerWidget : public QFrame
 	friend class SectionContentWidget;
 
 public:
+	/*!
+	 * Defines how restoreState() applies the deserialized layout.
+	 */
+	enum RestoreMode
+	{
+		RebuildRestore,    // Creates all sections, splitters and floating widgets from scratch
+		IncrementalRestore // Reuses existing widgets and only applies the difference to the current layout
+	};
+
 	explicit ContainerWidget(QWidget *parent = NULL);
 	virtual ~ContainerWidget();
 
@@ -52,6 +83,16 @@ public:
 	 */
 	SectionWidget* addSectionContent(const SectionContent::RefPtr& sc, SectionWidget* sw = NULL, DropArea area = CenterDropArea);
 
+	/*!
+	 * Moves the section <em>sw</em> with all of its contents next to <em>target</em>, or to the outer
+	 * <em>area</em> of this container, if <em>target</em> is NULL. The SectionWidget itself changes its
+	 * splitter, which keeps the tab order and the current tab. <em>CenterDropArea</em> merges the tabs
+	 * into <em>target</em> and deletes <em>sw</em>.
+	 * Returns false, if one of the sections is not docked in this container, or for
+	 * <em>CenterDropArea</em> without <em>target</em>.
+	 */
+	bool moveSection(SectionWidget* sw, SectionWidget* target, DropArea area);
+
 	/*!
 	 * Completely removes the <em>sc</em> from this ContainerWidget.
 	 * This container will no longer hold a reference to the content.
@@ -96,9 +137,98 @@ public:
 
 	/*!
 	 * Deserilizes the state of contents from <em>data</em>, which was written with <em>saveState()</em>.
+	 * With <em>IncrementalRestore</em> the existing sections, splitters and floating widgets are reused,
+	 * which makes switching between similar layouts cheap.
 	 * \see saveState()
 	 */
-	bool restoreState(const QByteArray& data);
+	bool restoreState(const QByteArray& data, RestoreMode mode = RebuildRestore);
+
+	/*!
+	 * Starts a batch of changes (e.g. many calls of addSectionContent() or hideSectionContent()).
+	 * Layout activation, repaints, the cleanup of empty splitters and
+	 * the <em>sectionContentVisibilityChanged()</em> signal are deferred until the matching
+	 * <em>endUpdate()</em> call. Calls can be nested, only the outermost pair commits.
+	 * \see endUpdate()
+	 */
+	void beginUpdate();
+
+	/*!
+	 * Commits the changes since the matching <em>beginUpdate()</em> call.
+	 * \see beginUpdate()
+	 */
+	void endUpdate();
+
+	/*!
+	 * Indicates whether a batch of changes is open.
+	 */
+	bool isUpdating() const;
+
+	/*!
+	 * Enables the hibernation of contents, which have been created with a SectionContentFactory.
+	 * The content widget of an inactive content (not visible tab, hidden or closed floating) gets destroyed,
+	 * if it has been inactive for <em>inactiveTimeout</em> milliseconds, or if the summed
+	 * SectionContentFactory::contentCost() of all loaded contents exceeds <em>budget</em>.
+	 * The least recently used contents are hibernated first. The tab stays in place and the widget
+	 * is created again on next activation, SectionContentFactory::saveContentState() and
+	 * SectionContentFactory::restoreContentState() carry its state.
+	 * A value of 0 disables the specific rule.
+	 */
+	void setHibernationPolicy(int inactiveTimeout, int budget);
+	int hibernationTimeout() const;
+	int hibernationBudget() const;
+
+	/*!
+	 * Destroys the content widget of the inactive content <em>sc</em> right now.
+	 * Returns false, if the content can not be hibernated (no factory, not loaded or visible).
+	 * \see setHibernationPolicy()
+	 */
+	bool hibernateSectionContent(const SectionContent::RefPtr& sc);
+
+	/*!
+	 * Enables the <em>sectionContentsChanged()</em> signal, which is disabled by default.
+	 */
+	void setSectionContentsChangedEnabled(bool enabled);
+	bool isSectionContentsChangedEnabled() const;
+
+	/*!
+	 * Enables the virtualized tab strip for sections, which are created afterwards.
+	 * Call it before adding contents or restoring a state.
+	 * The strip paints the tab titles from SectionContent::visibleTitle() and only shows
+	 * the title widgets of the current, hovered and dragged tab. This keeps adding and
+	 * switching tabs cheap for sections with hundreds of contents.
+	 * Disabled by default.
+	 */
+	void setVirtualTabsEnabled(bool enabled);
+	bool isVirtualTabsEnabled() const;
+
+	/*!
+	 * Renders the "activeTab" state of tab titles by switching between the two palettes,
+	 * instead of a repolish of the title widget on every change. Children of the title
+	 * widgets inherit the palette, as long as they do not set their own.
+	 * A style sheet overrides the palette, so title widgets with an application or parent
+	 * style sheet keep re-evaluating the rules on the <em>activeTab</em> property instead.
+	 */
+	void setActiveTabPalettes(const QPalette& inactive, const QPalette& active);
+	void unsetActiveTabPalettes();
+	bool hasActiveTabPalettes() const;
+
+	/*!
+	 * Dragging a tab out of its section shows a snapshot of the section, instead of
+	 * moving the live content inside a FloatingWidget. The content is moved only once
+	 * on release, into the drop target or into a new FloatingWidget at the release position.
+	 * Disabled by default.
+	 */
+	void setOutlineDragEnabled(bool enabled);
+	bool isOutlineDragEnabled() const;
+
+	/*!
+	 * Keeps up to <em>size</em> hidden FloatingWidget windows, which are reused when a
+	 * content is torn off, instead of creating a new native window each time.
+	 * The pool is filled right away, contents which dock back return their window.
+	 * Default is 0, which creates and deletes a window for every floating content.
+	 */
+	void setFloatingWidgetPoolSize(int size);
+	int floatingWidgetPoolSize() const;
 
 	//
 	// Advanced Public API
@@ -111,6 +241,14 @@ public:
 	QRect outerBottomDropRect() const;
 	QRect outerLeftDropRect() const;
 
+	/*!
+	 * Returns the SectionWidget at <em>pos</em> (relative to this container), or NULL.
+	 * The lookup uses an index of the section rectangles, which is only rebuilt after
+	 * sections or splitters have been moved, resized, added or removed. This keeps it
+	 * cheap to call on every mouse move of a drag.
+	 */
+	SectionWidget* sectionAt(const QPoint& pos) const;
+
 	/*!
 	 * \brief contents
 	 * \return List of known SectionContent for this ContainerWidget.
@@ -119,33 +257,69 @@ public:
 
 	QPointer<DropOverlay> dropOverlay() const;
 
+	/*!
+	 * Returns a widget independent model of the current layout.
+	 * The tree is cached and only rebuilt after the layout has changed.
+	 * \see DockLayoutTree
+	 */
+	DockLayoutTree layoutTree() const;
+
+protected:
+	virtual bool eventFilter(QObject* watched, QEvent* e);
+
 private:
 	//
 	// Internal Stuff Begins Here
 	//
 
 	SectionWidget* newSectionWidget();
+	FloatingWidget* newFloatingWidget(const InternalContentData& data);
+	void recycleFloatingWidget(FloatingWidget* fw);
+	FloatingWidget* floatingDropTargetAt(const QPoint& globalPos, QWidget* exclude) const;
+	QSplitter* newSplitter(Qt::Orientation orientation = Qt::Horizontal);
 	SectionWidget* dropContent(const InternalContentData& data, SectionWidget* targetSection, DropArea area, bool autoActive = true);
 	void addSection(SectionWidget* section);
-	SectionWidget* sectionAt(const QPoint& pos) const;
+	void updateSectionIndex() const;
 	SectionWidget* dropContentOuterHelper(QLayout* l, const InternalContentData& data, Qt::Orientation orientation, bool append);
+	void insertSection(SectionWidget* section, SectionWidget* targetSection, DropArea area);
+	void insertSectionOuter(QLayout* l, SectionWidget* section, Qt::Orientation orientation, bool append);
 
 	// Serialization
 	QByteArray saveHierarchy() const;
-	void saveFloatingWidgets(QDataStream& out) const;
-	void saveSectionWidgets(QDataStream& out, QWidget* widget) const;
+	void saveFloatingWidgets(QList<DockLayoutFloating>& floatings) const;
+	DockLayoutNode saveSectionWidgets(QWidget* widget, const QHash<int, QList<HiddenSectionItem> >& hiddenBySection) const;
+	void invalidateLayoutTree();
 
 	bool saveSectionIndex(ADS_NS_SER::SectionIndexData &sid) const;
 
 	bool restoreHierarchy(const QByteArray& data);
-	bool restoreFloatingWidgets(QDataStream& in, int version, QList<FloatingWidget*>& floatings);
-	bool restoreSectionWidgets(QDataStream& in, int version, QSplitter* currentSplitter, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& contentsToHide);
+	bool restoreFloatingWidgets(const QList<DockLayoutFloating>& data, QList<FloatingWidget*>& floatings);
+	FloatingWidget* restoreTabbedFloatingWidget(const DockLayoutFloating& data);
+	bool restoreSectionWidgets(const DockLayoutNode& node, QSplitter* currentSplitter, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& contentsToHide);
+	void restoreLeftContents(const QList<FloatingWidget*>& floatings, QList<SectionWidget*>& sections, const QList<SectionContent::RefPtr>& hiddenContents);
+
+	bool restoreHierarchyIncremental(const QByteArray& data);
+	QWidget* restoreSectionWidgetsIncremental(const DockLayoutNode& node, QList<QSplitter*>& splitterPool, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& hiddenContents, QList<QPair<QPointer<QSplitter>, QList<int> > >& splitterSizes);
 
 	bool takeContent(const SectionContent::RefPtr& sc, InternalContentData& data);
 
+	// Deferrable work (see beginUpdate())
+	void deleteEmptySplitterDeferred(QSplitter* splitter);
+	void emitSectionContentVisibilityChanged(const SectionContent::RefPtr& sc, bool visibleBefore, bool visible);
+
+	// Hibernation
+	void touchHibernation(int uid, bool visible);
+	void enforceHibernationBudget();
+
+	// Coalesced change notification
+	bool isSectionContentActive(const SectionContent::RefPtr& sc) const;
+	void recordSectionContentChange(const SectionContent::RefPtr& sc, bool visibility, bool valueBefore, bool value);
+
 private slots:
 	void onActiveTabChanged();
 	void onActionToggleSectionContentVisibility(bool visible);
+	void onHibernationTimeout();
+	void flushSectionContentChanges();
 
 signals:
 	void orientationChanged();
@@ -164,17 +338,30 @@ signals:
 	 */
 	void sectionContentVisibilityChanged(const SectionContent::RefPtr& sc, bool visible);
 
+	/*!
+	 * Emits once per event loop iteration, or at the end of a beginUpdate()/endUpdate() batch,
+	 * with all contents which changed their visibility or "isActiveTab" state in the meantime.
+	 * Contents which ended in their previous state are not part of <em>changes</em>.
+	 * Must be enabled with setSectionContentsChangedEnabled().
+	 */
+	void sectionContentsChanged(const QList<SectionContentChange>& changes);
+
 private:
 	// Elements inside container.
 	QList<SectionWidget*> _sections;
 	QList<FloatingWidget*> _floatings;
 	QHash<int, HiddenSectionItem> _hiddenSectionContents;
 
+	// Empty, hidden floating windows for reuse (see setFloatingWidgetPoolSize())
+	QList<FloatingWidget*> _floatingPool;
+	int _floatingPoolSize;
+
 
 	// Helper lookup maps, restricted to this container.
 	QHash<int, SectionContent::WeakPtr> _scLookupMapById;
 	QHash<QString, SectionContent::WeakPtr> _scLookupMapByName;
 	QHash<int, SectionWidget*> _swLookupMapById;
+	QHash<int, ContentLocation> _scLocationMapById; // Kept up to date on every structural change
 
 
 	// Layout stuff
@@ -185,6 +372,50 @@ private:
 
 	// Drop overlay stuff.
 	QPointer<DropOverlay> _dropOverlay;
+
+	// Batched updates (beginUpdate/endUpdate)
+	int _updateLevel;
+	bool _updatesWereEnabled;
+	bool _deleteEmptySplitterPending;
+	QList<QPointer<QSplitter> > _pendingEmptySplitters;
+	QList<int> _pendingVisibilityUids;
+	QHash<int, PendingVisibilityChange> _pendingVisibilityChanges;
+
+	// Hibernation of inactive contents (see setHibernationPolicy())
+	QTimer* _hibernationTimer;
+	int _hibernationTimeout;
+	int _hibernationBudget;
+	QList<int> _hibernationLru; // uids of loaded factory contents, least recently used first
+	QHash<int, qint64> _hibernationInactiveSince;
+
+	// Coalesced change notification (see sectionContentsChanged())
+	bool _contentsChangedEnabled;
+	bool _contentsChangedFlushScheduled;
+	QList<int> _changedContentUids;
+	QHash<int, SectionContentChange> _changedContents;
+
+	// Virtualized tab strip (see setVirtualTabsEnabled())
+	bool _virtualTabsEnabled;
+
+	// Snapshot dragging (see setOutlineDragEnabled())
+	bool _outlineDragEnabled;
+
+	// Active tab rendering (see setActiveTabPalettes())
+	bool _activeTabPalettesEnabled;
+	QPalette _inactiveTabPalette;
+	QPalette _activeTabPalette;
+
+	// Cached layout model (see layoutTree())
+	mutable DockLayoutTree _layoutTree;
+	mutable bool _layoutTreeDirty;
+
+	// Drop target index of section rectangles (see sectionAt())
+	mutable QVector<int> _sectionIndexLeft;
+	mutable QVector<int> _sectionIndexTop;
+	mutable QVector<int> _sectionIndexRight;
+	mutable QVector<int> _sectionIndexBottom;
+	mutable QVector<SectionWidget*> _sectionIndexWidgets;
+	mutable bool _sectionIndexDirty;
 };
 
 ADS_NAMESPACE_END
@@ -0,0 +1,44 @@
+#ifndef ADS_DOCKLAYOUTGEOMETRY_H
+#define ADS_DOCKLAYOUTGEOMETRY_H
+
+#include <QList>
+#include <QRect>
+#include <QSize>
+
+#include "ads/API.h"
+#include "ads/DockLayoutTree.h"
+
+ADS_NAMESPACE_BEGIN
+
+/*!
+ * DockLayoutGeometry computes the pixel geometry of sections for a DockLayoutTree,
+ * without creating any widget. It uses the same distribution rules as QSplitter
+ * (stored sizes are stretch factors, minimum sizes are respected), which makes
+ * the result match a restored ContainerWidget of the same size.
+ *
+ * \code
+ * DockLayoutTree tree;
+ * tree.fromState(state);
+ * QList<QRect> rects = DockLayoutGeometry::sectionGeometries(tree.root, QRect(0, 0, 800, 600), 5, QSize(60, 40));
+ * \endcode
+ */
+class ADS_EXPORT_API DockLayoutGeometry
+{
+public:
+	/*!
+	 * Returns the geometry of all sections below <em>node</em>, in the order of a
+	 * depth-first walk through the tree (same as the order of DockLayoutNode::children).
+	 * \param rect Geometry of the root splitter (contents rect of the ContainerWidget).
+	 * \param handleWidth Width of splitter handles, see QSplitter::handleWidth().
+	 * \param minimumSectionSize Minimum size of each section, see QWidget::minimumSizeHint().
+	 */
+	static QList<QRect> sectionGeometries(const DockLayoutNode& node, const QRect& rect, int handleWidth, const QSize& minimumSectionSize);
+
+	/*!
+	 * Returns the minimum size of <em>node</em>, the same way as QSplitter::minimumSizeHint() does.
+	 */
+	static QSize minimumSize(const DockLayoutNode& node, int handleWidth, const QSize& minimumSectionSize);
+};
+
+ADS_NAMESPACE_END
+#endif
@@ -0,0 +1,127 @@
+#ifndef ADS_DOCKLAYOUTTREE_H
+#define ADS_DOCKLAYOUTTREE_H
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+class QDataStream;
+
+#include "ads/API.h"
+
+ADS_NAMESPACE_BEGIN
+
+/*!
+ * A content entry of a DockLayoutNode::SectionNode.
+ */
+class ADS_EXPORT_API DockLayoutContent
+{
+public:
+	DockLayoutContent();
+	DockLayoutContent(const QString& uniqueName, bool visible, int preferredIndex);
+
+	bool operator==(const DockLayoutContent& other) const;
+	bool operator!=(const DockLayoutContent& other) const { return !operator==(other); }
+
+	QString uniqueName;
+	bool visible;
+	int preferredIndex;
+};
+
+/*!
+ * A node of the DockLayoutTree, which is either a splitter with child nodes
+ * or a section with contents (visible tabs first, followed by hidden contents
+ * which prefer this section).
+ */
+class ADS_EXPORT_API DockLayoutNode
+{
+public:
+	// Note: The values are used as type ids in the serialized hierarchy.
+	enum Type
+	{
+		InvalidNode = 0,
+		SplitterNode = 1,
+		SectionNode = 2
+	};
+
+	DockLayoutNode();
+
+	bool isValid() const { return type != InvalidNode; }
+	int sectionCount() const;
+
+	bool operator==(const DockLayoutNode& other) const;
+	bool operator!=(const DockLayoutNode& other) const { return !operator==(other); }
+
+	Type type;
+
+	// SplitterNode
+	Qt::Orientation orientation;
+	QList<int> sizes;
+	QList<DockLayoutNode> children;
+
+	// SectionNode
+	int currentIndex;
+	QList<DockLayoutContent> contents;
+	int sectionId; // Runtime id of the SectionWidget (-1 if unknown), not serialized and not compared
+};
+
+/*!
+ * A floating window of the DockLayoutTree, which shows a single content
+ * or several contents as tabs.
+ */
+class ADS_EXPORT_API DockLayoutFloating
+{
+public:
+	DockLayoutFloating();
+
+	bool operator==(const DockLayoutFloating& other) const;
+	bool operator!=(const DockLayoutFloating& other) const { return !operator==(other); }
+
+	bool isTabbed() const { return !tabs.isEmpty(); }
+
+	QString uniqueName;  // Content of a single content window, first tab of a tabbed window
+	QByteArray geometry;
+	bool visible;
+	QStringList tabs;    // Contents of a tabbed window, empty for a single content
+	int currentIndex;    // Current tab of a tabbed window
+};
+
+/*!
+ * DockLayoutTree is a value-type model of the layout of a ContainerWidget.
+ * It does not reference any QWidget, which makes it cheap to copy, compare
+ * and serialize. The ContainerWidget keeps its tree in sync with the widgets.
+ * \see ContainerWidget::layoutTree()
+ */
+class ADS_EXPORT_API DockLayoutTree
+{
+public:
+	DockLayoutTree();
+
+	bool operator==(const DockLayoutTree& other) const;
+	bool operator!=(const DockLayoutTree& other) const { return !operator==(other); }
+
+	/*!
+	 * Serializes the tree into the hierarchy format of ContainerWidget::saveState().
+	 */
+	QByteArray toByteArray() const;
+
+	/*!
+	 * Reads the tree from hierarchy data, which has been written with toByteArray().
+	 */
+	bool fromByteArray(const QByteArray& data);
+
+	/*!
+	 * Reads the tree from the complete data of ContainerWidget::saveState().
+	 */
+	bool fromState(const QByteArray& state);
+
+	QList<DockLayoutFloating> floatings;
+	DockLayoutNode root;             // InvalidNode, if there are no sections
+	QStringList hiddenContents;      // Hidden contents without (existing) section association
+};
+
+QDataStream& operator<<(QDataStream& out, const DockLayoutNode& node);
+
+ADS_NAMESPACE_END
+#endif
@@ -4,6 +4,7 @@
 #include <QPointer>
 #include <QHash>
 #include <QRect>
+#include <QVector>
 #include <QFrame>
 class QGridLayout;
 
@@ -22,17 +23,35 @@ class ADS_EXPORT_API DropOverlay : public QFrame
 	friend class DropOverlayCross;
 
 public:
+	enum Mode
+	{
+		/*! Overlay and cross are translucent top-level tool windows (default). */
+		TopLevelMode,
+
+		/*!
+		 * Overlay and cross are non-native child widgets of the parent, painted
+		 * above its other children. Requires no compositing window manager, but
+		 * targets have to be the parent or one of its descendants.
+		 */
+		ChildMode
+	};
+
 	DropOverlay(QWidget* parent);
 	virtual ~DropOverlay();
 
+	void setMode(Mode mode);
+	Mode mode() const;
+
 	void setAllowedAreas(DropAreas areas);
 	DropAreas allowedAreas() const;
 
 	void setAreaWidgets(const QHash<DropArea, QWidget*>& widgets);
 
 	DropArea cursorLocation() const;
+	DropArea dropAreaAt(const QPoint& globalPos) const;
 
 	DropArea showDropOverlay(QWidget* target);
+	DropArea showDropOverlay(QWidget* target, const QPoint& globalPos);
 	void showDropOverlay(QWidget* target, const QRect& targetAreaRect);
 	void hideDropOverlay();
 
@@ -44,6 +63,10 @@ protected:
 	virtual void moveEvent(QMoveEvent* e);
 
 private:
+	QRect targetGeometry(QWidget* target, const QRect& rect) const;
+
+private:
+	Mode _mode;
 	DropAreas _allowedAreas;
 	DropOverlayCross* _cross;
 
@@ -51,6 +74,9 @@ private:
 	QPointer<QWidget> _target;
 	QRect _targetRect;
 	DropArea _lastLocation;
+
+	// Global position of the parent in ChildMode, captured on show.
+	QPoint _parentGlobalPos;
 };
 
 /*!
@@ -68,18 +94,27 @@ public:
 	virtual ~DropOverlayCross();
 
 	void setAreaWidgets(const QHash<DropArea, QWidget*>& widgets);
-	DropArea cursorLocation() const;
+	DropArea areaAt(const QPoint& pos) const;
 
 protected:
+	virtual bool event(QEvent* e);
 	virtual void showEvent(QShowEvent* e);
+	virtual void resizeEvent(QResizeEvent* e);
 
 private:
 	void reset();
+	void updateAreaRects() const;
 
 private:
 	DropOverlay* _overlay;
 	QHash<DropArea, QWidget*> _widgets;
 	QGridLayout* _grid;
+
+	// Geometry of the visible and allowed area widgets,
+	// rebuilt lazily after any layout change.
+	mutable QVector<DropArea> _areas;
+	mutable QVector<QRect> _areaRects;
+	mutable bool _areaRectsDirty;
 };
 
 ADS_NAMESPACE_END
@@ -3,43 +3,58 @@
 
 #include <QWidget>
 class QBoxLayout;
+class QPushButton;
 
 #include "ads/API.h"
 #include "ads/SectionContent.h"
 
 ADS_NAMESPACE_BEGIN
 class ContainerWidget;
+class SectionWidget;
 class SectionTitleWidget;
 class SectionContentWidget;
 class InternalContentData;
 
 // FloatingWidget holds and displays SectionContent as a floating window.
 // It can be resized, moved and dropped back into a SectionWidget.
+// Contents dropped onto it turn it into a tabbed window, which shows a SectionWidget.
+// Without content it is an empty frame, which the ContainerWidget keeps for reuse.
 class FloatingWidget : public QWidget
 {
 	Q_OBJECT
 
 	friend class ContainerWidget;
+	friend class SectionWidget;
 
 public:
+	FloatingWidget(ContainerWidget* container, QWidget* parent = NULL);
 	FloatingWidget(ContainerWidget* container, SectionContent::RefPtr sc, SectionTitleWidget* titleWidget, SectionContentWidget* contentWidget, QWidget* parent = NULL);
 	virtual ~FloatingWidget();
 
 	SectionContent::RefPtr content() const { return _content; }
+	SectionWidget* section() const { return _section; }
+	QList<SectionContent::RefPtr> contents() const;
 
 public://private:
+	void setContent(SectionContent::RefPtr sc, SectionTitleWidget* titleWidget, SectionContentWidget* contentWidget);
 	bool takeContent(InternalContentData& data);
+	bool addContent(const InternalContentData& data);
 
 private slots:
 	void onCloseButtonClicked();
 
+private:
+	void createFrame();
+
 private:
 	ContainerWidget* _container;
 	SectionContent::RefPtr _content;
 	SectionTitleWidget* _titleWidget;
 	SectionContentWidget* _contentWidget;
+	SectionWidget* _section; // Tabbed window, replaces title and content widget
 
 	QBoxLayout* _titleLayout;
+	QPushButton* _closeButton;
 };
 
 ADS_NAMESPACE_END
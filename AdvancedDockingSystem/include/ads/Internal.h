@@ -14,11 +14,14 @@
 #define SCLookupMapById(X)   X->_scLookupMapById
 #define SCLookupMapByName(X) X->_scLookupMapByName
 #define SWLookupMapById(X)   X->_swLookupMapById
+#define SCLocationMapById(X) X->_scLocationMapById
 
 ADS_NAMESPACE_BEGIN
 class SectionContent;
 class SectionTitleWidget;
 class SectionContentWidget;
+class SectionWidget;
+class FloatingWidget;
 
 
 class InternalContentData
@@ -50,5 +53,53 @@ public:
 };
 
 
+/*!
+ * Describes where a SectionContent currently lives inside its ContainerWidget.
+ * The ContainerWidget keeps one entry per content and updates it on every
+ * structural change, which makes lookups by content-uid a simple hash access.
+ */
+class ContentLocation
+{
+public:
+	enum Type
+	{
+		UnknownLocation = 0,
+		SectionLocation,
+		FloatingLocation,
+		HiddenLocation
+	};
+
+	ContentLocation() :
+		type(UnknownLocation),
+		section(NULL),
+		floating(NULL),
+		index(-1)
+	{}
+
+	Type type;
+	SectionWidget* section;   // Valid for SectionLocation
+	FloatingWidget* floating; // Valid for FloatingLocation
+	int index;                // Tab index inside "section"
+};
+
+
+/*!
+ * Visibility change of a SectionContent, which has been recorded during
+ * ContainerWidget::beginUpdate() and gets emitted by ContainerWidget::endUpdate().
+ */
+class PendingVisibilityChange
+{
+public:
+	PendingVisibilityChange() :
+		visibleBefore(false),
+		visible(false)
+	{}
+
+	QSharedPointer<SectionContent> content;
+	bool visibleBefore;
+	bool visible;
+};
+
+
 ADS_NAMESPACE_END
 #endif
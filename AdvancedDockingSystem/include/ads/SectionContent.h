@@ -4,16 +4,49 @@
 #include <QSharedPointer>
 #include <QWeakPointer>
 #include <QPointer>
+#include <QString>
+#include <QByteArray>
 class QWidget;
 
 #include "ads/API.h"
 
 ADS_NAMESPACE_BEGIN
 class ContainerWidget;
+class SectionContentWidget;
+
+/*!
+ * Creates the content widget of a SectionContent on demand.
+ * Used for contents, which are expensive to create and may never be shown.
+ */
+class ADS_EXPORT_API SectionContentFactory
+{
+public:
+	virtual ~SectionContentFactory() {}
+
+	/*!
+	 * Creates the content widget for the SectionContent with <em>uniqueName</em>.
+	 * The SectionContent takes ownership of the returned widget.
+	 */
+	virtual QWidget* createContentWidget(const QString& uniqueName) = 0;
+
+	/*!
+	 * Saves the state of <em>widget</em>, before it gets destroyed by the hibernation of ContainerWidget.
+	 * The data is passed to restoreContentState(), after the widget has been created again.
+	 * \see ContainerWidget::setHibernationPolicy()
+	 */
+	virtual QByteArray saveContentState(const QString& uniqueName, QWidget* widget) { Q_UNUSED(uniqueName) Q_UNUSED(widget) return QByteArray(); }
+	virtual void restoreContentState(const QString& uniqueName, QWidget* widget, const QByteArray& state) { Q_UNUSED(uniqueName) Q_UNUSED(widget) Q_UNUSED(state) }
+
+	/*!
+	 * Returns the memory cost of <em>widget</em>, which is used for the hibernation budget.
+	 */
+	virtual int contentCost(const QString& uniqueName, QWidget* widget) { Q_UNUSED(uniqueName) Q_UNUSED(widget) return 1; }
+};
 
 class ADS_EXPORT_API SectionContent
 {
 	friend class ContainerWidget;
+	friend class SectionContentWidget;
 
 private:
 	SectionContent();
@@ -43,12 +76,21 @@ public:
 	 */
 	static RefPtr newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, QWidget* content);
 
+	/*!
+	 * Creates new content like above, but the content widget is created by <em>factory</em>,
+	 * when the content becomes visible for the first time or contentWidget() gets called.
+	 * Until then the section shows an empty placeholder.
+	 * \param factory Creates the content widget, it is shared with other contents.
+	 */
+	static RefPtr newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, const QSharedPointer<SectionContentFactory>& factory);
+
 	virtual ~SectionContent();
 	int uid() const;
 	QString uniqueName() const;
 	ContainerWidget* containerWidget() const;
 	QWidget* titleWidget() const;
-	QWidget* contentWidget() const;
+	QWidget* contentWidget() const; // Creates the widget, if it has not been loaded yet
+	bool isContentWidgetLoaded() const;
 	Flags flags() const;
 
 	QString visibleTitle() const;
@@ -56,6 +98,10 @@ public:
 	void setTitle(const QString& title);
 	void setFlags(const Flags f);
 
+private:
+	static RefPtr newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, QWidget* content, const QSharedPointer<SectionContentFactory>& factory);
+	void loadContentWidget();
+
 private:
 	const int _uid;
 	QString _uniqueName;
@@ -63,6 +109,10 @@ private:
 	QPointer<ContainerWidget> _containerWidget;
 	QPointer<QWidget> _titleWidget;
 	QPointer<QWidget> _contentWidget;
+	QSharedPointer<SectionContentFactory> _contentFactory;
+	QPointer<QWidget> _contentWrapper; // SectionContentWidget, which receives the lazy created widget
+	QByteArray _hibernatedState;
+	bool _hibernated;
 
 	// Optional attributes
 	QString _title;
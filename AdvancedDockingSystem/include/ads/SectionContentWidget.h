@@ -20,6 +20,10 @@ public:
 	SectionContentWidget(SectionContent::RefPtr c, QWidget* parent = 0);
 	virtual ~SectionContentWidget();
 
+protected:
+	virtual void showEvent(QShowEvent*);
+	virtual void hideEvent(QHideEvent*);
+
 private:
 	SectionContent::RefPtr _content;
 };
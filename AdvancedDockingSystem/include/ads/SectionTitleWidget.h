@@ -20,19 +20,43 @@ class SectionTitleWidget : public QFrame
 
 	friend class ContainerWidget;
 	friend class SectionWidget;
+	friend class SectionTabStrip;
+	friend class FloatingWidget;
 
 	SectionContent::RefPtr _content;
 
 	// Drag & Drop (Floating)
 	QPointer<FloatingWidget> _fw;
 	QPoint _dragStartPos;
+	QPoint _containerGlobalPos; // ContainerWidget origin, captured on press
+	QPoint _fwStartPos; // position of an existing FloatingWidget on press
+	QPointer<SectionWidget> _originSection; // kept until the drop, even if it is empty
+	int _originIndex;
+
+	// Drag & Drop (Outline, see ContainerWidget::setOutlineDragEnabled())
+	QPointer<QWidget> _dragPreview;
+	QPoint _dragPreviewOffset;
 
 	// Drag & Drop (Title/Tabs)
 	bool _tabMoving;
+	QPointer<SectionWidget> _tabTarget; // other section, which gets this tab on release
+	int _tabTargetIndex;
 
 	// Property values
 	bool _activeTab;
 
+	bool usesActiveTabPalettes() const;
+	void updateActiveTabStyle();
+	void showDropIndicator(ContainerWidget* cw, const QPoint& globalPos);
+	DropArea dropTargetAt(ContainerWidget* cw, const QPoint& globalPos, SectionWidget*& section, FloatingWidget*& floating);
+	void dropOutlineDrag(ContainerWidget* cw, const QPoint& globalPos);
+	SectionWidget* tabStripTargetAt(ContainerWidget* cw, const QPoint& globalPos, SectionWidget* source) const;
+	bool isNearTitleArea(ContainerWidget* cw, const QPoint& globalPos) const;
+	void setTabTarget(SectionWidget* target, int index);
+	void dropToTabTarget(SectionWidget* source);
+	void releaseOrigin();
+	void cancelDrag();
+
 public:
 	SectionTitleWidget(SectionContent::RefPtr content, QWidget* parent);
 	virtual ~SectionTitleWidget();
@@ -44,6 +68,8 @@ protected:
 	virtual void mousePressEvent(QMouseEvent* ev);
 	virtual void mouseReleaseEvent(QMouseEvent* ev);
 	virtual void mouseMoveEvent(QMouseEvent* ev);
+	virtual void keyPressEvent(QKeyEvent* ev);
+	virtual void changeEvent(QEvent* e);
 
 signals:
 	void activeTabChanged();
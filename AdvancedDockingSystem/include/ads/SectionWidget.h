@@ -4,12 +4,15 @@
 #include <QDebug>
 #include <QPointer>
 #include <QList>
+#include <QVector>
 #include <QFrame>
 #include <QScrollArea>
 class QBoxLayout;
 class QStackedLayout;
 class QPushButton;
 class QMenu;
+class QAction;
+class QLabel;
 
 #include "ads/API.h"
 #include "ads/Internal.h"
@@ -19,6 +22,7 @@ ADS_NAMESPACE_BEGIN
 class ContainerWidget;
 class SectionTitleWidget;
 class SectionContentWidget;
+class SectionTabStrip;
 
 // SectionWidget manages multiple instances of SectionContent.
 // It displays a title TAB, which is clickable and will switch to
@@ -27,6 +31,8 @@ class ADS_EXPORT_API SectionWidget : public QFrame
 {
 	Q_OBJECT
 	friend class ContainerWidget;
+	friend class SectionTitleWidget;
+	friend class SectionTabStrip;
 
 	explicit SectionWidget(ContainerWidget* parent);
 
@@ -52,6 +58,10 @@ public:
 
 protected:
 	virtual void showEvent(QShowEvent*);
+	virtual bool eventFilter(QObject* watched, QEvent* e);
+	virtual void mousePressEvent(QMouseEvent* ev);
+	virtual void mouseMoveEvent(QMouseEvent* ev);
+	virtual void mouseReleaseEvent(QMouseEvent* ev);
 
 public slots:
 	void setCurrentIndex(int index);
@@ -59,9 +69,24 @@ public slots:
 private slots:
 	void onSectionTitleClicked();
 	void onCloseButtonClicked();
-	void onTabsMenuActionTriggered(bool);
-	void updateTabsMenu();
+	void onTabsMenuActionTriggered(QAction* a);
+	void buildTabsMenu();
 
+private:
+	void updateTabsMenu();
+	void updateContentLocations(int fromIndex);
+	DropArea sectionDropTargetAt(const QPoint& globalPos, SectionWidget*& target) const;
+
+	// Tab slots (hit testing and insertion marker while moving a tab)
+	const QVector<int>& tabExtents() const;
+	QRect tabSlotGeometry(int index) const;
+	void showTabInsertMarker(int from, int to);
+	void hideTabInsertMarker();
+	int tabInsertIndexAt(const QPoint& pos) const;
+	void showTabDropMarker(int index);
+	void placeTabInsertMarker(int x);
+	void showGhostTab(const QString& title);
+	void hideGhostTab();
 
 private:
 	const int _uid;
@@ -76,12 +101,21 @@ private:
 	QWidget* _tabsContainerWidget;
 	QBoxLayout* _tabsLayout;
 	QPushButton* _tabsMenuButton;
+	QMenu* _tabsMenu;
 	QPushButton* _closeButton;
 	int _tabsLayoutInitCount; // used for calculations on _tabsLayout modification calls.
+	SectionTabStrip* _tabStrip; // replaces _tabsLayout, if ContainerWidget::isVirtualTabsEnabled()
+	QPointer<SectionTitleWidget> _activeTitleWidget; // title of the current tab, deactivated on next switch
+	mutable QVector<int> _tabExtents; // right edge of each tab in _tabsLayout, rebuilt after relayout
+	mutable bool _tabExtentsDirty;
+	QWidget* _tabInsertMarker;
+	QLabel* _ghostTab; // placeholder of the last tab while it is dragged out of this section
+	bool _tabsMenuOutdated; // the tabs menu is rebuilt when it shows up the next time
 
 	QStackedLayout *_contentsLayout;
 
-	QPoint _mousePressPoint;
+	QPoint _mousePressPoint; // press on the empty title area, which may start a section move
+	bool _sectionMoving;
 	SectionContent::RefPtr _mousePressContent;
 	SectionTitleWidget* _mousePressTitleWidget;
 
@@ -99,5 +133,50 @@ protected:
 	virtual void wheelEvent(QWheelEvent*);
 };
 
+/*
+	Virtualized tab strip, which paints the tab titles from the contents of the
+	SectionWidget. Only the title widgets of the current, hovered and dragged tabs
+	are shown, all other title widgets stay hidden and are not part of any layout.
+	\see ContainerWidget::setVirtualTabsEnabled()
+*/
+class SectionTabStrip : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit SectionTabStrip(SectionWidget* sectionWidget);
+	virtual ~SectionTabStrip();
+
+	void insertTab(int index);
+	void removeTab(int index);
+	void moveTab(int from, int to);
+
+	int count() const;
+	int tabAt(const QPoint& pos) const;
+	QRect tabRect(int index) const;
+	void ensureTabVisible(int index);
+	void updateTitleWidgets();
+
+	virtual QSize sizeHint() const;
+	virtual QSize minimumSizeHint() const;
+
+protected:
+	virtual void paintEvent(QPaintEvent*);
+	virtual void mousePressEvent(QMouseEvent*);
+	virtual void mouseMoveEvent(QMouseEvent*);
+	virtual void leaveEvent(QEvent*);
+	virtual void changeEvent(QEvent*);
+
+private:
+	int tabWidth(int index) const;
+	void updateOffsets(int fromIndex);
+
+	SectionWidget* _sectionWidget;
+	QVector<int> _tabWidths;
+	QVector<int> _tabOffsets; // left edge of each tab, followed by the total width
+	int _hoverIndex;
+	QList<QPointer<SectionTitleWidget> > _shownTitleWidgets;
+};
+
 ADS_NAMESPACE_END
 #endif
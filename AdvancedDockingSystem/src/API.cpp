@@ -10,41 +10,49 @@
 
 ADS_NAMESPACE_BEGIN
 
-static bool splitterContainsSectionWidget(QSplitter* splitter)
+// Deletes empty splitters bottom-up and returns whether "w" contains a SectionWidget.
+static bool deleteEmptySplitterRecursive(QWidget* w)
 {
-	for (int i = 0; i < splitter->count(); ++i)
+	if (qobject_cast<SectionWidget*>(w) != NULL)
+		return true;
+
+	QSplitter* sp = qobject_cast<QSplitter*>(w);
+	if (!sp)
+		return false;
+
+	// Iterate backwards, deleted children don't shift the remaining indices.
+	bool containsSectionWidget = false;
+	for (int i = sp->count() - 1; i >= 0; --i)
 	{
-		QWidget* w = splitter->widget(i);
-		QSplitter* sp = qobject_cast<QSplitter*>(w);
-		SectionWidget* sw = NULL;
-		if (sp && splitterContainsSectionWidget(sp))
-			return true;
-		else if ((sw = qobject_cast<SectionWidget*>(w)) != NULL)
-			return true;
+		if (deleteEmptySplitterRecursive(sp->widget(i)))
+			containsSectionWidget = true;
 	}
-	return false;
+	if (!containsSectionWidget && sp->property("ads-splitter").toBool())
+		delete sp;
+	return containsSectionWidget;
 }
 
 void deleteEmptySplitter(ContainerWidget* container)
 {
-	bool doAgain = false;
-	do
+	// Root splitters are direct children of the container,
+	// including those which are no longer part of its layout.
+	const QObjectList children = container->children();
+	for (int i = 0; i < children.count(); ++i)
 	{
-		doAgain = false;
-		QList<QSplitter*> splitters = container->findChildren<QSplitter*>();
-		for (int i = 0; i < splitters.count(); ++i)
-		{
-			QSplitter* sp = splitters.at(i);
-			if (!sp->property("ads-splitter").toBool())
-				continue;
-			if (sp->count() > 0 && splitterContainsSectionWidget(sp))
-				continue;
-			delete splitters[i];
-			doAgain = true;
-			break;
-		}
+		QSplitter* sp = qobject_cast<QSplitter*>(children.at(i));
+		if (sp)
+			deleteEmptySplitterRecursive(sp);
+	}
+}
+
+void deleteEmptySplitter(QSplitter* splitter)
+{
+	while (splitter && splitter->count() == 0 && splitter->property("ads-splitter").toBool())
+	{
+		QSplitter* parentSplitter = qobject_cast<QSplitter*>(splitter->parentWidget());
+		delete splitter;
+		splitter = parentSplitter;
 	}
-	while (doAgain);
 }
 
 ContainerWidget* findParentContainerWidget(QWidget* w)
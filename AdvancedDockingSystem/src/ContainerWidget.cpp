@@ -10,6 +10,8 @@
 #include <QtGlobal>
 #include <QGridLayout>
 #include <QPoint>
+#include <QTimer>
+#include <QDateTime>
 
 #include "ads/Internal.h"
 #include "ads/SectionWidget.h"
@@ -22,28 +24,66 @@ ADS_NAMESPACE_BEGIN
 
 // Static Helper //////////////////////////////////////////////////////
 
-static QSplitter* newSplitter(Qt::Orientation orientation = Qt::Horizontal, QWidget* parent = 0)
+static void collectSplitters(QSplitter* splitter, QList<QSplitter*>& splitters)
 {
-	QSplitter* s = new QSplitter(orientation, parent);
-	s->setProperty("ads-splitter", QVariant(true));
-	s->setChildrenCollapsible(false);
-	s->setOpaqueResize(false);
-	return s;
+	splitters.append(splitter);
+	for (int i = 0; i < splitter->count(); ++i)
+	{
+		QSplitter* sp = qobject_cast<QSplitter*>(splitter->widget(i));
+		if (sp)
+			collectSplitters(sp, splitters);
+	}
+}
+
+// Indicates whether "node" contains a visible content, which is known by "lookupMap".
+static bool containsVisibleContent(const DockLayoutNode& node, const QHash<QString, SectionContent::WeakPtr>& lookupMap)
+{
+	for (int i = 0; i < node.children.count(); ++i)
+	{
+		if (containsVisibleContent(node.children.at(i), lookupMap))
+			return true;
+	}
+	for (int i = 0; i < node.contents.count(); ++i)
+	{
+		if (node.contents.at(i).visible && lookupMap.contains(node.contents.at(i).uniqueName))
+			return true;
+	}
+	return false;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 ContainerWidget::ContainerWidget(QWidget *parent) :
 	QFrame(parent),
+	_floatingPoolSize(0),
 	_mainLayout(NULL),
 	_orientation(Qt::Horizontal),
 	_splitter(NULL),
-	_dropOverlay(new DropOverlay(this))
+	_dropOverlay(new DropOverlay(this)),
+	_updateLevel(0),
+	_updatesWereEnabled(true),
+	_deleteEmptySplitterPending(false),
+	_hibernationTimer(new QTimer(this)),
+	_hibernationTimeout(0),
+	_hibernationBudget(0),
+	_contentsChangedEnabled(false),
+	_contentsChangedFlushScheduled(false),
+	_virtualTabsEnabled(false),
+	_outlineDragEnabled(false),
+	_activeTabPalettesEnabled(false),
+	_layoutTreeDirty(true),
+	_sectionIndexDirty(true)
 {
 	_mainLayout = new QGridLayout();
 	_mainLayout->setContentsMargins(9, 9, 9, 9);
 	_mainLayout->setSpacing(0);
 	setLayout(_mainLayout);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	QObject::connect(_hibernationTimer, &QTimer::timeout, this, &ContainerWidget::onHibernationTimeout);
+#else
+	QObject::connect(_hibernationTimer, SIGNAL(timeout()), this, SLOT(onHibernationTimeout()));
+#endif
 }
 
 ContainerWidget::~ContainerWidget()
@@ -62,9 +102,12 @@ ContainerWidget::~ContainerWidget()
 		FloatingWidget* fw = _floatings.takeLast();
 		delete fw;
 	}
+	qDeleteAll(_floatingPool);
+	_floatingPool.clear();
 	_scLookupMapById.clear();
 	_scLookupMapByName.clear();
 	_swLookupMapById.clear();
+	_scLocationMapById.clear();
 }
 
 SectionWidget* ContainerWidget::addSectionContent(const SectionContent::RefPtr& sc, SectionWidget* sw, DropArea area)
@@ -86,6 +129,68 @@ SectionWidget* ContainerWidget::addSectionContent(const SectionContent::RefPtr&
 	return dropContent(data, sw, area, false);
 }
 
+bool ContainerWidget::moveSection(SectionWidget* sw, SectionWidget* target, DropArea area)
+{
+	ADS_Expects(sw != NULL);
+
+	if (!_sections.contains(sw) || (target && !_sections.contains(target)))
+	{
+		qWarning() << "Can not move a section, which is not docked in this container";
+		return false;
+	}
+	if (area != TopDropArea && area != RightDropArea && area != BottomDropArea
+			&& area != LeftDropArea && area != CenterDropArea)
+	{
+		qWarning() << "Invalid drop area for section move" << area;
+		return false;
+	}
+	if (!target && area == CenterDropArea)
+	{
+		qWarning() << "Can not merge a section without target section";
+		return false;
+	}
+	if (sw == target)
+		return true;
+
+	QSplitter* oldSplitter = qobject_cast<QSplitter*>(sw->parentWidget());
+
+	if (target && area == CenterDropArea)
+	{
+		// Merge the tabs, the current one of "sw" stays current.
+		const int currentIndex = target->contents().count() + sw->currentIndex();
+		while (!sw->contents().isEmpty())
+		{
+			InternalContentData data;
+			if (!sw->takeContent(sw->contents().first()->uid(), data))
+				break;
+			target->addContent(data, false);
+		}
+		target->setCurrentIndex(currentIndex);
+
+		// Called from event handlers of "sw", it leaves its splitter now and goes away later.
+		_sections.removeAll(sw);
+		SWLookupMapById(this).remove(sw->uid());
+		sw->hide();
+		sw->setParent(this);
+		sw->deleteLater();
+	}
+	else if (target)
+	{
+		insertSection(sw, target, area);
+	}
+	else
+	{
+		const Qt::Orientation orientation = (area == LeftDropArea || area == RightDropArea) ? Qt::Horizontal : Qt::Vertical;
+		insertSectionOuter(_mainLayout, sw, orientation, area != TopDropArea && area != LeftDropArea);
+	}
+
+	if (oldSplitter)
+		deleteEmptySplitterDeferred(oldSplitter);
+	_sectionIndexDirty = true;
+	invalidateLayoutTree();
+	return true;
+}
+
 bool ContainerWidget::removeSectionContent(const SectionContent::RefPtr& sc)
 {
 	ADS_Expects(!sc.isNull());
@@ -95,26 +200,25 @@ bool ContainerWidget::removeSectionContent(const SectionContent::RefPtr& sc)
 	if (!hideSectionContent(sc))
 		return false;
 
-	// Begin of ugly work arround.
-	// TODO The hideSectionContent() method should take care of deleting FloatingWidgets and SectionWidgets,
-	// but only cares about SectionWidgets right now. So we need to check whether it was a FloatingWidget
-	// and delete it.
-	bool found = false;
-	for (int i = 0; i < _floatings.count(); ++i)
+	_hibernationLru.removeAll(sc->uid());
+	_hibernationInactiveSince.remove(sc->uid());
+
+	// The hideSectionContent() method only hides FloatingWidgets,
+	// which means we need to delete it here.
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+	if (loc.type == ContentLocation::FloatingLocation)
 	{
-		FloatingWidget* fw = _floatings.at(i);
+		FloatingWidget* fw = loc.floating;
 		InternalContentData data;
-		if (!(found = fw->takeContent(data)))
-			continue;
-		_floatings.removeAll(fw);
-		delete fw;
+		fw->takeContent(data);
+		recycleFloatingWidget(fw);
 		delete data.titleWidget;
 		delete data.contentWidget;
-		break;
-	} // End of ugly work arround.
+		return true;
+	}
 
 	// Get from hidden contents and delete associated internal stuff.
-	if (!_hiddenSectionContents.contains(sc->uid()))
+	if (loc.type != ContentLocation::HiddenLocation)
 	{
 		qFatal("Something went wrong... The content should have been there :-/");
 		return false;
@@ -122,6 +226,8 @@ bool ContainerWidget::removeSectionContent(const SectionContent::RefPtr& sc)
 
 	// Delete internal objects.
 	HiddenSectionItem hsi = _hiddenSectionContents.take(sc->uid());
+	_scLocationMapById.remove(sc->uid());
+	invalidateLayoutTree();
 	delete hsi.data.titleWidget;
 	delete hsi.data.contentWidget;
 
@@ -135,39 +241,41 @@ bool ContainerWidget::showSectionContent(const SectionContent::RefPtr& sc)
 {
 	ADS_Expects(!sc.isNull());
 
-	// Search SC in floatings
-	for (int i = 0; i < _floatings.count(); ++i)
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+
+	// SC is floating
+	if (loc.type == ContentLocation::FloatingLocation)
 	{
-		FloatingWidget* fw = _floatings.at(i);
-		const bool found = fw->content()->uid() == sc->uid();
-		if (!found)
-			continue;
+		FloatingWidget* fw = loc.floating;
+		const bool visibleBefore = fw->isVisible();
 		fw->setVisible(true);
 		fw->_titleWidget->setVisible(true);
 		fw->_contentWidget->setVisible(true);
-		emit sectionContentVisibilityChanged(sc, true);
+		emitSectionContentVisibilityChanged(sc, visibleBefore, true);
 		return true;
 	}
 
-	// Search SC in hidden sections
+	// SC is hidden
 	// Try to show them in the last position, otherwise simply append
 	// it to the first section (or create a new section?)
-	if (_hiddenSectionContents.contains(sc->uid()))
+	if (loc.type == ContentLocation::HiddenLocation)
 	{
 		const HiddenSectionItem hsi = _hiddenSectionContents.take(sc->uid());
+		_scLocationMapById.remove(sc->uid());
+		invalidateLayoutTree();
 		hsi.data.titleWidget->setVisible(true);
 		hsi.data.contentWidget->setVisible(true);
 		SectionWidget* sw = NULL;
 		if (hsi.preferredSectionId > 0 && (sw = SWLookupMapById(this).value(hsi.preferredSectionId)) != NULL)
 		{
 			sw->addContent(hsi.data, true);
-			emit sectionContentVisibilityChanged(sc, true);
+			emitSectionContentVisibilityChanged(sc, false, true);
 			return true;
 		}
 		else if (_sections.size() > 0 && (sw = _sections.first()) != NULL)
 		{
 			sw->addContent(hsi.data, true);
-			emit sectionContentVisibilityChanged(sc, true);
+			emitSectionContentVisibilityChanged(sc, false, true);
 			return true;
 		}
 		else
@@ -175,7 +283,7 @@ bool ContainerWidget::showSectionContent(const SectionContent::RefPtr& sc)
 			sw = newSectionWidget();
 			addSection(sw);
 			sw->addContent(hsi.data, true);
-			emit sectionContentVisibilityChanged(sc, true);
+			emitSectionContentVisibilityChanged(sc, false, true);
 			return true;
 		}
 	}
@@ -190,52 +298,51 @@ bool ContainerWidget::hideSectionContent(const SectionContent::RefPtr& sc)
 {
 	ADS_Expects(!sc.isNull());
 
-	// Search SC in floatings
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+
+	// SC is floating
 	// We can simply hide floatings, nothing else required.
-	for (int i = 0; i < _floatings.count(); ++i)
+	if (loc.type == ContentLocation::FloatingLocation)
 	{
-		const bool found = _floatings.at(i)->content()->uid() == sc->uid();
-		if (!found)
-			continue;
-		_floatings.at(i)->setVisible(false);
-		emit sectionContentVisibilityChanged(sc, false);
+		const bool visibleBefore = loc.floating->isVisible();
+		loc.floating->setVisible(false);
+		emitSectionContentVisibilityChanged(sc, visibleBefore, false);
 		return true;
 	}
 
-	// Search SC in sections
+	// SC is part of a section
 	// It's required to remove the SC from SW completely and hold it in a
 	// separate list as long as a "showSectionContent" gets called for the SC again.
 	// In case that the SW does not have any other SCs, we need to delete it.
-	for (int i = 0; i < _sections.count(); ++i)
+	if (loc.type == ContentLocation::SectionLocation)
 	{
-		SectionWidget* sw = _sections.at(i);
-		const bool found = sw->indexOfContent(sc) >= 0;
-		if (!found)
-			continue;
+		SectionWidget* sw = loc.section;
 
 		HiddenSectionItem hsi;
 		hsi.preferredSectionId = sw->uid();
-		hsi.preferredSectionIndex = sw->indexOfContent(sc);
+		hsi.preferredSectionIndex = loc.index;
 		if (!sw->takeContent(sc->uid(), hsi.data))
 			return false;
 
 		hsi.data.titleWidget->setVisible(false);
 		hsi.data.contentWidget->setVisible(false);
 		_hiddenSectionContents.insert(sc->uid(), hsi);
+		_scLocationMapById[sc->uid()].type = ContentLocation::HiddenLocation;
+		invalidateLayoutTree();
 
 		if (sw->contents().isEmpty())
 		{
+			QSplitter* splitter = qobject_cast<QSplitter*>(sw->parentWidget());
 			delete sw;
 			sw = NULL;
-			deleteEmptySplitter(this);
+			deleteEmptySplitterDeferred(splitter);
 		}
-		emit sectionContentVisibilityChanged(sc, false);
+		emitSectionContentVisibilityChanged(sc, true, false);
 		return true;
 	}
 
-	// Search SC in hidden elements
 	// The content may already be hidden
-	if (_hiddenSectionContents.contains(sc->uid()))
+	if (loc.type == ContentLocation::HiddenLocation)
 		return true;
 
 	qFatal("Unable to hide SectionContent, don't know this one 8-/");
@@ -246,30 +353,25 @@ bool ContainerWidget::raiseSectionContent(const SectionContent::RefPtr& sc)
 {
 	ADS_Expects(!sc.isNull());
 
-	// Search SC in sections
-	for (int i = 0; i < _sections.count(); ++i)
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+
+	// SC is part of a section
+	if (loc.type == ContentLocation::SectionLocation)
 	{
-		SectionWidget* sw = _sections.at(i);
-		int index = sw->indexOfContent(sc);
-		if (index < 0)
-			continue;
-		sw->setCurrentIndex(index);
+		loc.section->setCurrentIndex(loc.index);
 		return true;
 	}
 
-	// Search SC in floatings
-	for (int i = 0; i < _floatings.size(); ++i)
+	// SC is floating
+	if (loc.type == ContentLocation::FloatingLocation)
 	{
-		FloatingWidget* fw = _floatings.at(i);
-		if (fw->content()->uid() != sc->uid())
-			continue;
-		fw->setVisible(true);
-		fw->raise();
+		loc.floating->setVisible(true);
+		loc.floating->raise();
 		return true;
 	}
 
-	// Search SC in hidden
-	if (_hiddenSectionContents.contains(sc->uid()))
+	// SC is hidden
+	if (loc.type == ContentLocation::HiddenLocation)
 		return showSectionContent(sc);
 
 	qFatal("Unable to hide SectionContent, don't know this one 8-/");
@@ -280,28 +382,18 @@ bool ContainerWidget::isSectionContentVisible(const SectionContent::RefPtr& sc)
 {
 	ADS_Expects(!sc.isNull());
 
-	// Search SC in floatings
-	for (int i = 0; i < _floatings.count(); ++i)
-	{
-		const bool found = _floatings.at(i)->content()->uid() == sc->uid();
-		if (!found)
-			continue;
-		return _floatings.at(i)->isVisible();
-	}
-
-	// Search SC in sections
-	for (int i = 0; i < _sections.count(); ++i)
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+	switch (loc.type)
 	{
-		SectionWidget* sw = _sections.at(i);
-		const int index = sw->indexOfContent(sc);
-		if (index < 0)
-			continue;
+	case ContentLocation::FloatingLocation:
+		return loc.floating->isVisible();
+	case ContentLocation::SectionLocation:
 		return true;
-	}
-
-	// Search SC in hidden
-	if (_hiddenSectionContents.contains(sc->uid()))
+	case ContentLocation::HiddenLocation:
 		return false;
+	default:
+		break;
+	}
 
 	qWarning() << "SectionContent is not a part of this ContainerWidget:" << sc->uniqueName();
 	return false;
@@ -360,20 +452,22 @@ QMenu* ContainerWidget::createContextMenu() const
 	for (int i = 0; i < _floatings.size(); ++i)
 	{
 		const FloatingWidget* fw = _floatings.at(i);
-		const SectionContent::RefPtr sc = fw->content();
-
-		QAction* a = new QAction(QIcon(), sc->visibleTitle(), NULL);
-		a->setObjectName(QString("ads-action-sc-%1").arg(QString::number(sc->uid())));
-		a->setProperty("uid", sc->uid());
-		a->setProperty("type", "floating");
-		a->setCheckable(true);
-		a->setChecked(fw->isVisible());
+		const QList<SectionContent::RefPtr> contents = fw->contents();
+		foreach (const SectionContent::RefPtr& sc, contents)
+		{
+			QAction* a = new QAction(QIcon(), sc->visibleTitle(), NULL);
+			a->setObjectName(QString("ads-action-sc-%1").arg(QString::number(sc->uid())));
+			a->setProperty("uid", sc->uid());
+			a->setProperty("type", "floating");
+			a->setCheckable(true);
+			a->setChecked(fw->isVisible());
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-		QObject::connect(a, &QAction::toggled, this, &ContainerWidget::onActionToggleSectionContentVisibility);
+			QObject::connect(a, &QAction::toggled, this, &ContainerWidget::onActionToggleSectionContentVisibility);
 #else
-		QObject::connect(a, SIGNAL(toggled(bool)), this, SLOT(onActionToggleSectionContentVisibility(bool)));
+			QObject::connect(a, SIGNAL(toggled(bool)), this, SLOT(onActionToggleSectionContentVisibility(bool)));
 #endif
-		actions.insert(a->text(), a);
+			actions.insert(a->text(), a);
+		}
 	}
 
 	// Create menu from "actions"
@@ -405,7 +499,7 @@ QByteArray ContainerWidget::saveState() const
 	return writer.toByteArray();
 }
 
-bool ContainerWidget::restoreState(const QByteArray& data)
+bool ContainerWidget::restoreState(const QByteArray& data, RestoreMode mode)
 {
 	if (data.isEmpty())
 		return false;
@@ -418,8 +512,196 @@ bool ContainerWidget::restoreState(const QByteArray& data)
 	QByteArray hierarchyData;
 	if (reader.read(ADS_NS_SER::ET_Hierarchy, hierarchyData))
 	{
-		restoreHierarchy(hierarchyData);
+		beginUpdate();
+		if (mode == IncrementalRestore)
+			restoreHierarchyIncremental(hierarchyData);
+		else
+			restoreHierarchy(hierarchyData);
+		endUpdate();
+	}
+	return true;
+}
+
+void ContainerWidget::beginUpdate()
+{
+	if (_updateLevel++ > 0)
+		return;
+
+	_updatesWereEnabled = updatesEnabled();
+	setUpdatesEnabled(false);
+	_mainLayout->setEnabled(false);
+}
+
+void ContainerWidget::endUpdate()
+{
+	if (_updateLevel <= 0)
+	{
+		qWarning() << Q_FUNC_INFO << "Not matching any beginUpdate() call";
+		return;
+	}
+	if (--_updateLevel > 0)
+		return;
+
+	// Structural cleanup, once for the entire batch.
+	if (_deleteEmptySplitterPending)
+	{
+		_deleteEmptySplitterPending = false;
+		deleteEmptySplitter(this);
+	}
+	else
+	{
+		for (int i = 0; i < _pendingEmptySplitters.count(); ++i)
+			deleteEmptySplitter(_pendingEmptySplitters.at(i).data());
+	}
+	_pendingEmptySplitters.clear();
+
+	// One layout pass.
+	_mainLayout->setEnabled(true);
+	_mainLayout->activate();
+	setUpdatesEnabled(_updatesWereEnabled);
+	update();
+
+	// Signals of contents, which changed their visibility in the end.
+	const QList<int> uids = _pendingVisibilityUids;
+	const QHash<int, PendingVisibilityChange> changes = _pendingVisibilityChanges;
+	_pendingVisibilityUids.clear();
+	_pendingVisibilityChanges.clear();
+	for (int i = 0; i < uids.count(); ++i)
+	{
+		const PendingVisibilityChange& pvc = changes[uids.at(i)];
+		if (pvc.visible != pvc.visibleBefore)
+			emit sectionContentVisibilityChanged(pvc.content, pvc.visible);
+	}
+	flushSectionContentChanges();
+}
+
+bool ContainerWidget::isUpdating() const
+{
+	return _updateLevel > 0;
+}
+
+void ContainerWidget::setHibernationPolicy(int inactiveTimeout, int budget)
+{
+	_hibernationTimeout = qMax(inactiveTimeout, 0);
+	_hibernationBudget = qMax(budget, 0);
+
+	// Check a few times per timeout period, a content may get unloaded a bit later than exactly after the timeout.
+	if (_hibernationTimeout > 0)
+		_hibernationTimer->start(qBound(1, _hibernationTimeout / 4, 60000));
+	else
+		_hibernationTimer->stop();
+
+	enforceHibernationBudget();
+}
+
+int ContainerWidget::hibernationTimeout() const
+{
+	return _hibernationTimeout;
+}
+
+int ContainerWidget::hibernationBudget() const
+{
+	return _hibernationBudget;
+}
+
+void ContainerWidget::setSectionContentsChangedEnabled(bool enabled)
+{
+	_contentsChangedEnabled = enabled;
+	if (!enabled)
+	{
+		_changedContentUids.clear();
+		_changedContents.clear();
+	}
+}
+
+bool ContainerWidget::isSectionContentsChangedEnabled() const
+{
+	return _contentsChangedEnabled;
+}
+
+void ContainerWidget::setVirtualTabsEnabled(bool enabled)
+{
+	_virtualTabsEnabled = enabled;
+}
+
+bool ContainerWidget::isVirtualTabsEnabled() const
+{
+	return _virtualTabsEnabled;
+}
+
+void ContainerWidget::setActiveTabPalettes(const QPalette& inactive, const QPalette& active)
+{
+	_activeTabPalettesEnabled = true;
+	_inactiveTabPalette = inactive;
+	_activeTabPalette = active;
+
+	// Includes titles of floating widgets and hidden contents.
+	foreach (SectionTitleWidget* stw, findChildren<SectionTitleWidget*>())
+		stw->updateActiveTabStyle();
+}
+
+void ContainerWidget::unsetActiveTabPalettes()
+{
+	if (!_activeTabPalettesEnabled)
+		return;
+	_activeTabPalettesEnabled = false;
+	_inactiveTabPalette = QPalette();
+	_activeTabPalette = QPalette();
+
+	foreach (SectionTitleWidget* stw, findChildren<SectionTitleWidget*>())
+		stw->updateActiveTabStyle();
+}
+
+bool ContainerWidget::hasActiveTabPalettes() const
+{
+	return _activeTabPalettesEnabled;
+}
+
+void ContainerWidget::setOutlineDragEnabled(bool enabled)
+{
+	_outlineDragEnabled = enabled;
+}
+
+bool ContainerWidget::isOutlineDragEnabled() const
+{
+	return _outlineDragEnabled;
+}
+
+void ContainerWidget::setFloatingWidgetPoolSize(int size)
+{
+	_floatingPoolSize = qMax(size, 0);
+	while (_floatingPool.count() > _floatingPoolSize)
+		delete _floatingPool.takeLast();
+
+	// Pre-warm, the native window is the expensive part of a new floating window.
+	while (_floatingPool.count() < _floatingPoolSize)
+	{
+		FloatingWidget* fw = new FloatingWidget(this, this);
+		fw->winId();
+		_floatingPool.append(fw);
 	}
+}
+
+int ContainerWidget::floatingWidgetPoolSize() const
+{
+	return _floatingPoolSize;
+}
+
+bool ContainerWidget::hibernateSectionContent(const SectionContent::RefPtr& sc)
+{
+	ADS_Expects(!sc.isNull());
+
+	if (!sc->_contentFactory || !sc->isContentWidgetLoaded())
+		return false;
+	if (sc->_contentWrapper && sc->_contentWrapper->isVisible())
+		return false;
+
+	sc->_hibernatedState = sc->_contentFactory->saveContentState(sc->uniqueName(), sc->_contentWidget);
+	sc->_hibernated = true;
+	delete sc->_contentWidget; // Also removes it from the layout of SectionContentWidget.
+
+	_hibernationLru.removeAll(sc->uid());
+	_hibernationInactiveSince.remove(sc->uid());
 	return true;
 }
 
@@ -477,9 +759,65 @@ SectionWidget* ContainerWidget::newSectionWidget()
 {
 	SectionWidget* sw = new SectionWidget(this);
 	_sections.append(sw);
+	_sectionIndexDirty = true;
 	return sw;
 }
 
+// Returns a FloatingWidget holding "data", from the pool if possible.
+// The caller shows it and adds it to the list of floatings.
+FloatingWidget* ContainerWidget::newFloatingWidget(const InternalContentData& data)
+{
+	if (_floatingPool.isEmpty())
+		return new FloatingWidget(this, data.content, data.titleWidget, data.contentWidget, this);
+
+	FloatingWidget* fw = _floatingPool.takeLast();
+	fw->setContent(data.content, data.titleWidget, data.contentWidget);
+	return fw;
+}
+
+// Hides the empty "fw" and keeps it for reuse, or deletes it if the pool is full.
+void ContainerWidget::recycleFloatingWidget(FloatingWidget* fw)
+{
+	_floatings.removeAll(fw);
+	// Callers may be running inside an event handler of the window.
+	if (fw->_titleWidget || fw->_contentWidget || fw->_section || _floatingPool.count() >= _floatingPoolSize)
+	{
+		fw->hide();
+		fw->deleteLater();
+		return;
+	}
+	fw->hide();
+	fw->_content.clear();
+	_floatingPool.append(fw);
+}
+
+// Returns the visible floating window at "globalPos", which accepts drops of contents.
+// Floating windows are no drop targets for a DropOverlay in ChildMode, it can't paint on them.
+FloatingWidget* ContainerWidget::floatingDropTargetAt(const QPoint& globalPos, QWidget* exclude) const
+{
+	if (_dropOverlay->mode() == DropOverlay::ChildMode)
+		return NULL;
+
+	// Later floatings are usually on top.
+	for (int i = _floatings.count() - 1; i >= 0; --i)
+	{
+		FloatingWidget* fw = _floatings.at(i);
+		if (fw != exclude && fw->isVisible() && fw->frameGeometry().contains(globalPos))
+			return fw;
+	}
+	return NULL;
+}
+
+QSplitter* ContainerWidget::newSplitter(Qt::Orientation orientation)
+{
+	QSplitter* s = new QSplitter(orientation);
+	s->setProperty("ads-splitter", QVariant(true));
+	s->setChildrenCollapsible(false);
+	s->setOpaqueResize(false);
+	s->installEventFilter(this); // Keeps the layout tree up to date
+	return s;
+}
+
 SectionWidget* ContainerWidget::dropContent(const InternalContentData& data, SectionWidget* targetSection, DropArea area, bool autoActive)
 {
 	ADS_Expects(targetSection != NULL);
@@ -518,88 +856,17 @@ SectionWidget* ContainerWidget::dropContent(const InternalContentData& data, Sec
 		return ret;
 	}
 
-	QSplitter* targetSectionSplitter = findParentSplitter(targetSection);
-
 	// Drop logic based on area.
 	switch (area)
 	{
 	case TopDropArea:
-	{
-		SectionWidget* sw = newSectionWidget();
-		sw->addContent(data, true);
-		if (targetSectionSplitter->orientation() == Qt::Vertical)
-		{
-			const int index = targetSectionSplitter->indexOf(targetSection);
-			targetSectionSplitter->insertWidget(index, sw);
-		}
-		else
-		{
-			const int index = targetSectionSplitter->indexOf(targetSection);
-			QSplitter* s = newSplitter(Qt::Vertical);
-			s->addWidget(sw);
-			s->addWidget(targetSection);
-			targetSectionSplitter->insertWidget(index, s);
-		}
-		ret = sw;
-		break;
-	}
 	case RightDropArea:
-	{
-		SectionWidget* sw = newSectionWidget();
-		sw->addContent(data, true);
-		if (targetSectionSplitter->orientation() == Qt::Horizontal)
-		{
-			const int index = targetSectionSplitter->indexOf(targetSection);
-			targetSectionSplitter->insertWidget(index + 1, sw);
-		}
-		else
-		{
-			const int index = targetSectionSplitter->indexOf(targetSection);
-			QSplitter* s = newSplitter(Qt::Horizontal);
-			s->addWidget(targetSection);
-			s->addWidget(sw);
-			targetSectionSplitter->insertWidget(index, s);
-		}
-		ret = sw;
-		break;
-	}
 	case BottomDropArea:
-	{
-		SectionWidget* sw = newSectionWidget();
-		sw->addContent(data, true);
-		if (targetSectionSplitter->orientation() == Qt::Vertical)
-		{
-			int index = targetSectionSplitter->indexOf(targetSection);
-			targetSectionSplitter->insertWidget(index + 1, sw);
-		}
-		else
-		{
-			int index = targetSectionSplitter->indexOf(targetSection);
-			QSplitter* s = newSplitter(Qt::Vertical);
-			s->addWidget(targetSection);
-			s->addWidget(sw);
-			targetSectionSplitter->insertWidget(index, s);
-		}
-		ret = sw;
-		break;
-	}
 	case LeftDropArea:
 	{
 		SectionWidget* sw = newSectionWidget();
 		sw->addContent(data, true);
-		if (targetSectionSplitter->orientation() == Qt::Horizontal)
-		{
-			int index = targetSectionSplitter->indexOf(targetSection);
-			targetSectionSplitter->insertWidget(index, sw);
-		}
-		else
-		{
-			QSplitter* s = newSplitter(Qt::Horizontal);
-			s->addWidget(sw);
-			int index = targetSectionSplitter->indexOf(targetSection);
-			targetSectionSplitter->insertWidget(index, s);
-			s->addWidget(targetSection);
-		}
+		insertSection(sw, targetSection, area);
 		ret = sw;
 		break;
 	}
@@ -615,12 +882,40 @@ SectionWidget* ContainerWidget::dropContent(const InternalContentData& data, Sec
 	return ret;
 }
 
-void ContainerWidget::addSection(SectionWidget* section)
+// Inserts "section" next to "targetSection" at the outer "area" of the target and creates
+// a new splitter, if the orientation of the target splitter doesn't match. A section which
+// is part of a splitter already is moved, QSplitter takes it out of the old one.
+void ContainerWidget::insertSection(SectionWidget* section, SectionWidget* targetSection, DropArea area)
 {
-	ADS_Expects(section != NULL);
+	QSplitter* targetSectionSplitter = findParentSplitter(targetSection);
+	const Qt::Orientation orientation = (area == LeftDropArea || area == RightDropArea) ? Qt::Horizontal : Qt::Vertical;
+	const bool append = (area == RightDropArea || area == BottomDropArea);
 
-	// Create default splitter.
-	if (!_splitter)
+	if (targetSectionSplitter->orientation() == orientation)
+	{
+		// QSplitter::insertWidget() counts the index after taking out the moved widget.
+		int index = targetSectionSplitter->indexOf(targetSection);
+		const int from = targetSectionSplitter->indexOf(section);
+		if (from >= 0 && from < index)
+			--index;
+		targetSectionSplitter->insertWidget(append ? index + 1 : index, section);
+	}
+	else
+	{
+		QSplitter* s = newSplitter(orientation);
+		s->addWidget(section);
+		const int index = targetSectionSplitter->indexOf(targetSection);
+		targetSectionSplitter->insertWidget(index, s);
+		s->insertWidget(append ? 0 : 1, targetSection);
+	}
+}
+
+void ContainerWidget::addSection(SectionWidget* section)
+{
+	ADS_Expects(section != NULL);
+
+	// Create default splitter.
+	if (!_splitter)
 	{
 		_splitter = newSplitter(_orientation);
 		_mainLayout->addWidget(_splitter, 0, 0);
@@ -635,24 +930,62 @@ void ContainerWidget::addSection(SectionWidget* section)
 
 SectionWidget* ContainerWidget::sectionAt(const QPoint& pos) const
 {
-	const QPoint gpos = mapToGlobal(pos);
-	for (int i = 0; i < _sections.size(); ++i)
+	if (_sectionIndexDirty)
+		updateSectionIndex();
+
+	const int x = pos.x();
+	const int y = pos.y();
+	const int count = _sectionIndexWidgets.count();
+	const int* left = _sectionIndexLeft.constData();
+	const int* top = _sectionIndexTop.constData();
+	const int* right = _sectionIndexRight.constData();
+	const int* bottom = _sectionIndexBottom.constData();
+	for (int i = 0; i < count; ++i)
 	{
-		SectionWidget* sw = _sections[i];
-		if (sw->rect().contains(sw->mapFromGlobal(gpos)))
-		{
-			return sw;
-		}
+		if (x >= left[i] && x <= right[i] && y >= top[i] && y <= bottom[i])
+			return _sectionIndexWidgets.at(i);
 	}
 	return 0;
 }
 
+// Rebuilds the rectangles of all sections, relative to this container.
+// Invalidated by eventFilter(), whenever a section or splitter changes its geometry.
+void ContainerWidget::updateSectionIndex() const
+{
+	const int count = _sections.count();
+	_sectionIndexLeft.resize(count);
+	_sectionIndexTop.resize(count);
+	_sectionIndexRight.resize(count);
+	_sectionIndexBottom.resize(count);
+	_sectionIndexWidgets.resize(count);
+	for (int i = 0; i < count; ++i)
+	{
+		SectionWidget* sw = _sections.at(i);
+		const QRect r(sw->mapTo(const_cast<ContainerWidget*>(this), QPoint(0, 0)), sw->size());
+		_sectionIndexLeft[i] = r.left();
+		_sectionIndexTop[i] = r.top();
+		_sectionIndexRight[i] = r.right();
+		_sectionIndexBottom[i] = r.bottom();
+		_sectionIndexWidgets[i] = sw;
+	}
+	_sectionIndexDirty = false;
+}
+
 SectionWidget* ContainerWidget::dropContentOuterHelper(QLayout* l, const InternalContentData& data, Qt::Orientation orientation, bool append)
 {
 	ADS_Expects(l != NULL);
 
 	SectionWidget* sw = newSectionWidget();
 	sw->addContent(data, true);
+	insertSectionOuter(l, sw, orientation, append);
+	return sw;
+}
+
+// Inserts "sw" at the outer edge of the root splitter, which gets wrapped
+// by a new splitter if its orientation doesn't match.
+void ContainerWidget::insertSectionOuter(QLayout* l, SectionWidget* sw, Qt::Orientation orientation, bool append)
+{
+	ADS_Expects(l != NULL);
 
 	QSplitter* oldsp = findImmediateSplitter(this);
 	if (!oldsp)
@@ -712,169 +1045,162 @@ SectionWidget* ContainerWidget::dropContentOuterHelper(QLayout* l, const Interna
 #endif
 		}
 	}
-	return sw;
 }
 
-QByteArray ContainerWidget::saveHierarchy() const
+DockLayoutTree ContainerWidget::layoutTree() const
 {
-	/*
-		# Data Format
-
-		quint32                   Magic
-		quint32                   Version
-
-		int                       Number of floating widgets
-		LOOP                      Floating widgets
-			QString               Unique name of content
-			QByteArray            Geometry of floating widget
-			bool                  Visibility
-
-		int                       Number of layout items (Valid values: 0, 1)
-		IF 0
-			int                   Number of hidden contents
-			LOOP                  Contents
-				QString           Unique name of content
-		ELSEIF 1
-			... todo ...
-		ENDIF
-	*/
-	QByteArray ba;
-	QDataStream out(&ba, QIODevice::WriteOnly);
-	out.setVersion(QDataStream::Qt_4_5);
-	out << (quint32) 0x00001337; // Magic
-	out << (quint32) 1; // Version
-
-	// Save state of floating contents
-	saveFloatingWidgets(out);
-
-	// Save state of sections and contents
-	if (_mainLayout->count() <= 0 || _sections.isEmpty())
-	{
-		// Looks like the user has hidden all contents and no more sections
-		// are available. We can simply write a list of all hidden contents.
-		out << 0; // Mode
-
-		out << _hiddenSectionContents.count();
-		QHashIterator<int, HiddenSectionItem> iter(_hiddenSectionContents);
-		while (iter.hasNext())
-		{
-			iter.next();
-			out << iter.value().data.content->uniqueName();
-		}
-	}
-	else if (_mainLayout->count() == 1)
+	if (_layoutTreeDirty)
 	{
-		out << 1; // Mode
-
-		// There should only be one!
-		QLayoutItem* li = _mainLayout->itemAt(0);
-		if (!li->widget())
-			qFatal("Not a widget in _mainLayout, this shouldn't happen.");
-
-		// Save sections beginning with the first QSplitter (li->widget()).
-		saveSectionWidgets(out, li->widget());
+		_layoutTree = DockLayoutTree();
 
-		// Safe state of hidden contents, which doesn't have an section association
-		// or the section association points to a no longer existing section.
-		QHashIterator<int, HiddenSectionItem> iter(_hiddenSectionContents);
-		int cnt = 0;
-		while (iter.hasNext())
+		if (_mainLayout->count() <= 0 || _sections.isEmpty())
 		{
-			iter.next();
-			if (iter.value().preferredSectionId <= 0 || !SWLookupMapById(this).contains(iter.value().preferredSectionId))
-				cnt++;
+			// Looks like the user has hidden all contents and no more sections
+			// are available. The tree simply holds a list of all hidden contents.
+			QHashIterator<int, HiddenSectionItem> iter(_hiddenSectionContents);
+			while (iter.hasNext())
+			{
+				iter.next();
+				_layoutTree.hiddenContents.append(iter.value().data.content->uniqueName());
+			}
 		}
-		out << cnt;
-		iter.toFront();
-		while (iter.hasNext())
+		else if (_mainLayout->count() == 1)
 		{
-			iter.next();
-			if (iter.value().preferredSectionId <= 0 || !SWLookupMapById(this).contains(iter.value().preferredSectionId))
-				out << iter.value().data.content->uniqueName();
+			// There should only be one!
+			QLayoutItem* li = _mainLayout->itemAt(0);
+			if (!li->widget())
+				qFatal("Not a widget in _mainLayout, this shouldn't happen.");
+
+			// Group hidden contents by their section association. Contents which doesn't have an
+			// section association or which points to a no longer existing section are "lonely".
+			QHash<int, QList<HiddenSectionItem> > hiddenBySection;
+			QHashIterator<int, HiddenSectionItem> iter(_hiddenSectionContents);
+			while (iter.hasNext())
+			{
+				iter.next();
+				const HiddenSectionItem& hsi = iter.value();
+				// Sections of tabbed floating windows are not part of the tree.
+				if (hsi.preferredSectionId <= 0 || !_sections.contains(SWLookupMapById(this).value(hsi.preferredSectionId)))
+					_layoutTree.hiddenContents.append(hsi.data.content->uniqueName());
+				else
+					hiddenBySection[hsi.preferredSectionId].append(hsi);
+			}
+
+			// Build nodes beginning with the first QSplitter (li->widget()).
+			_layoutTree.root = saveSectionWidgets(li->widget(), hiddenBySection);
 		}
+		else
+		{
+			// More? Oh oh.. something is wrong :-/
+			qWarning() << "Oh noooz.. Something went wrong. There are too many items in _mainLayout.";
+		}
+		_layoutTreeDirty = false;
 	}
-	else
+
+	// Floating widgets are cheap to collect and can be moved without
+	// any notification, which is why they are never cached.
+	DockLayoutTree tree = _layoutTree;
+	saveFloatingWidgets(tree.floatings);
+	return tree;
+}
+
+bool ContainerWidget::eventFilter(QObject* watched, QEvent* e)
+{
+	// Installed on splitters and sections to keep track of size and structure changes.
+	switch (e->type())
 	{
-		// More? Oh oh.. something is wrong :-/
-		out << -1;
-		qWarning() << "Oh noooz.. Something went wrong. There are too many items in _mainLayout.";
+	case QEvent::Resize:
+	case QEvent::ChildAdded:
+	case QEvent::ChildRemoved:
+		_layoutTreeDirty = true;
+		_sectionIndexDirty = true;
+		break;
+	case QEvent::Move:
+	case QEvent::Show:
+	case QEvent::Hide:
+		_sectionIndexDirty = true;
+		break;
+	default:
+		break;
 	}
-	return ba;
+	return QFrame::eventFilter(watched, e);
 }
 
-void ContainerWidget::saveFloatingWidgets(QDataStream& out) const
+QByteArray ContainerWidget::saveHierarchy() const
+{
+	// See DockLayoutTree::toByteArray() for the data format.
+	return layoutTree().toByteArray();
+}
+
+void ContainerWidget::saveFloatingWidgets(QList<DockLayoutFloating>& floatings) const
 {
-	out << _floatings.count();
 	for (int i = 0; i < _floatings.count(); ++i)
 	{
 		FloatingWidget* fw = _floatings.at(i);
-		out << fw->content()->uniqueName();
-		out << fw->saveGeometry();
-		out << fw->isVisible();
+		DockLayoutFloating f;
+		if (fw->_section)
+		{
+			const QList<SectionContent::RefPtr> contents = fw->_section->contents();
+			for (int j = 0; j < contents.count(); ++j)
+				f.tabs.append(contents.at(j)->uniqueName());
+			f.uniqueName = f.tabs.value(0);
+			f.currentIndex = fw->_section->currentIndex();
+		}
+		else
+		{
+			f.uniqueName = fw->content()->uniqueName();
+		}
+		f.geometry = fw->saveGeometry();
+		f.visible = fw->isVisible();
+		floatings.append(f);
 	}
 }
 
-void ContainerWidget::saveSectionWidgets(QDataStream& out, QWidget* widget) const
+DockLayoutNode ContainerWidget::saveSectionWidgets(QWidget* widget, const QHash<int, QList<HiddenSectionItem> >& hiddenBySection) const
 {
+	DockLayoutNode node;
 	QSplitter* sp = NULL;
 	SectionWidget* sw = NULL;
 
 	if (!widget)
 	{
-		out << 0;
+		return node;
 	}
-	else if ((sp = dynamic_cast<QSplitter*>(widget)) != NULL)
+	else if ((sp = qobject_cast<QSplitter*>(widget)) != NULL)
 	{
-		out << 1; // Type = QSplitter
-		out << ((sp->orientation() == Qt::Horizontal) ? (int) 1 : (int) 2);
-		out << sp->count();
-		out << sp->sizes();
+		node.type = DockLayoutNode::SplitterNode;
+		node.orientation = sp->orientation();
+		node.sizes = sp->sizes();
 		for (int i = 0; i < sp->count(); ++i)
 		{
-			saveSectionWidgets(out, sp->widget(i));
+			node.children.append(saveSectionWidgets(sp->widget(i), hiddenBySection));
 		}
 	}
-	else if ((sw = dynamic_cast<SectionWidget*>(widget)) != NULL)
+	else if ((sw = qobject_cast<SectionWidget*>(widget)) != NULL)
 	{
-		// Format (version 1)
-		//	int  Object type (SectionWidget=2)
-		//	int  Current active index
-		//	int  Number of contents (visible + hidden)
-		//	LOOP Contents of section (last int)
-		//		QString  Unique name of SectionContent
-		//		bool     Visibility
-		//		int      Preferred index
-
+		// Visible contents first, followed by hidden contents which prefer this section.
 		const QList<SectionContent::RefPtr>& contents = sw->contents();
-		QList<HiddenSectionItem> hiddenContents;
-
-		QHashIterator<int, HiddenSectionItem> iter(_hiddenSectionContents);
-		while (iter.hasNext())
-		{
-			iter.next();
-			const HiddenSectionItem& hsi = iter.value();
-			if (hsi.preferredSectionId != sw->uid())
-				continue;
-			hiddenContents.append(hsi);
-		}
-
-		out << 2; // Type = SectionWidget
-		out << sw->currentIndex();
-		out << contents.count() + hiddenContents.count();
+		const QList<HiddenSectionItem> hiddenContents = hiddenBySection.value(sw->uid());
 
+		node.type = DockLayoutNode::SectionNode;
+		node.currentIndex = sw->currentIndex();
+		node.sectionId = sw->uid();
 		for (int i = 0; i < contents.count(); ++i)
 		{
-			out << contents[i]->uniqueName(); // Unique name
-			out << (bool) true; // Visiblity
-			out << i; // Index
+			node.contents.append(DockLayoutContent(contents[i]->uniqueName(), true, i));
 		}
 		for (int i = 0; i < hiddenContents.count(); ++i)
 		{
-			out << hiddenContents.at(i).data.content->uniqueName();
-			out << (bool) false;
-			out << hiddenContents.at(i).preferredSectionIndex;
+			const HiddenSectionItem& hsi = hiddenContents.at(i);
+			node.contents.append(DockLayoutContent(hsi.data.content->uniqueName(), false, hsi.preferredSectionIndex));
 		}
 	}
+	return node;
+}
+
+void ContainerWidget::invalidateLayoutTree()
+{
+	_layoutTreeDirty = true;
 }
 
 bool ContainerWidget::saveSectionIndex(ADS_NS_SER::SectionIndexData& sid) const
@@ -907,17 +1233,8 @@ bool ContainerWidget::saveSectionIndex(ADS_NS_SER::SectionIndexData& sid) const
 
 bool ContainerWidget::restoreHierarchy(const QByteArray& data)
 {
-	QDataStream in(data);
-	in.setVersion(QDataStream::Qt_4_5);
-
-	quint32 magic = 0;
-	in >> magic;
-	if (magic != 0x00001337)
-		return false;
-
-	quint32 version = 0;
-	in >> version;
-	if (version != 1)
+	DockLayoutTree tree;
+	if (!tree.fromByteArray(data))
 		return false;
 
 	QList<FloatingWidget*> oldFloatings = _floatings;
@@ -925,7 +1242,7 @@ bool ContainerWidget::restoreHierarchy(const QByteArray& data)
 
 	// Restore floating widgets
 	QList<FloatingWidget*> floatings;
-	bool success = restoreFloatingWidgets(in, version, floatings);
+	bool success = restoreFloatingWidgets(tree.floatings, floatings);
 	if (!success)
 	{
 		qWarning() << "Could not restore floatings completely";
@@ -935,25 +1252,18 @@ bool ContainerWidget::restoreHierarchy(const QByteArray& data)
 	QList<SectionWidget*> sections;
 	QList<SectionContent::RefPtr> contentsToHide;
 
-	int mode = 0;
-	in >> mode;
-	if (mode == 0)
+	if (!tree.root.isValid())
 	{
 		// List of hidden contents. There are no sections at all.
-		int cnt = 0;
-		in >> cnt;
-
-		if(cnt > 0)
+		if (!tree.hiddenContents.isEmpty())
 		{
 			// Create dummy section, required to call hideSectionContent() later.
 			SectionWidget* sw = new SectionWidget(this);
 			sections.append(sw);
 
-			for (int i = 0; i < cnt; ++i)
+			for (int i = 0; i < tree.hiddenContents.count(); ++i)
 			{
-				QString uname;
-				in >> uname;
-
+				const QString& uname = tree.hiddenContents.at(i);
 				const SectionContent::RefPtr sc = SCLookupMapByName(this).value(uname);
 				if (!sc)
 					continue;
@@ -967,19 +1277,16 @@ bool ContainerWidget::restoreHierarchy(const QByteArray& data)
 			}
 		}
 	}
-	else if (mode == 1)
+	else
 	{
-		success = restoreSectionWidgets(in, version, NULL, sections, contentsToHide);
+		success = restoreSectionWidgets(tree.root, NULL, sections, contentsToHide);
 		if (!success)
 			qWarning() << "Could not restore sections completely";
 
 		// Restore lonely hidden contents
-		int cnt = 0;
-		in >> cnt;
-		for (int i = 0; i < cnt; ++i)
+		for (int i = 0; i < tree.hiddenContents.count(); ++i)
 		{
-			QString uname;
-			in >> uname;
+			const QString& uname = tree.hiddenContents.at(i);
 			const SectionContent::RefPtr sc = SCLookupMapByName(this).value(uname);
 			if (!sc)
 				continue;
@@ -1003,138 +1310,160 @@ bool ContainerWidget::restoreHierarchy(const QByteArray& data)
 	}
 
 	// Handle SectionContent which is not mentioned by deserialized data.
-	// What shall we do with it? For now: Simply drop them into the first SectionWidget.
-	if (true)
-	{
-		QList<SectionContent::RefPtr> leftContents;
-
-		// Collect all contents which has been restored
-		QList<SectionContent::RefPtr> contents;
-		for (int i = 0; i < floatings.count(); ++i)
-			contents.append(floatings.at(i)->content());
-		for (int i = 0; i < sections.count(); ++i)
-			for (int j = 0; j < sections.at(i)->contents().count(); ++j)
-				contents.append(sections.at(i)->contents().at(j));
-		for (int i = 0; i < contentsToHide.count(); ++i)
-			contents.append(contentsToHide.at(i));
-
-		// Compare restored contents with available contents
-		const QList<SectionContent::WeakPtr> allContents = SCLookupMapById(this).values();
-		for (int i = 0; i < allContents.count(); ++i)
-		{
-			const SectionContent::RefPtr sc = allContents.at(i).toStrongRef();
-			if (sc.isNull() || sc->containerWidget() != this)
-				continue;
-			if (contents.contains(sc))
-				continue;
-			leftContents.append(sc);
-		}
-
-		// What should we do with a drunken sailor.. what should.. erm..
-		// What should we do with the left-contents?
-		// Lets add them to the first found SW or create one, if no SW is available.
-		for (int i = 0; i < leftContents.count(); ++i)
-		{
-			const SectionContent::RefPtr sc = leftContents.at(i);
-			SectionWidget* sw = NULL;
-
-			if (sections.isEmpty())
-			{
-				sw = new SectionWidget(this);
-				sections.append(sw);
-				addSection(sw);
-			}
-			else
-				sw = sections.first();
-
-			InternalContentData data;
-			if (!takeContent(sc, data))
-				sw->addContent(sc);
-			else
-				sw->addContent(data, false);
-		}
-	}
+	restoreLeftContents(floatings, sections, contentsToHide);
 
 	_floatings = floatings;
 	_sections = sections;
+	_sectionIndexDirty = true;
 
 	// Delete old objects
 	QLayoutItem* old = _mainLayout->takeAt(0);
 	_mainLayout->addWidget(_splitter);
 	delete old;
-	qDeleteAll(oldFloatings);
+	for (int i = 0; i < oldFloatings.count(); ++i)
+		recycleFloatingWidget(oldFloatings.at(i));
 	qDeleteAll(oldSections);
 
 	// Hide all as "hidden" marked contents
 	for (int i = 0; i < contentsToHide.count(); ++i)
 		hideSectionContent(contentsToHide.at(i));
 
-	deleteEmptySplitter(this);
+	deleteEmptySplitterDeferred(NULL);
 	return success;
 }
 
-bool ContainerWidget::restoreFloatingWidgets(QDataStream& in, int version, QList<FloatingWidget*>& floatings)
+void ContainerWidget::restoreLeftContents(const QList<FloatingWidget*>& floatings, QList<SectionWidget*>& sections, const QList<SectionContent::RefPtr>& hiddenContents)
 {
-	Q_UNUSED(version)
+	// What shall we do with contents, which are not mentioned by deserialized data?
+	// For now: Simply drop them into the first SectionWidget.
+	QList<SectionContent::RefPtr> leftContents;
+
+	// Collect all contents which has been restored
+	QList<SectionContent::RefPtr> contents;
+	for (int i = 0; i < floatings.count(); ++i)
+		contents.append(floatings.at(i)->contents());
+	for (int i = 0; i < sections.count(); ++i)
+		for (int j = 0; j < sections.at(i)->contents().count(); ++j)
+			contents.append(sections.at(i)->contents().at(j));
+	for (int i = 0; i < hiddenContents.count(); ++i)
+		contents.append(hiddenContents.at(i));
+
+	// Compare restored contents with available contents
+	const QList<SectionContent::WeakPtr> allContents = SCLookupMapById(this).values();
+	for (int i = 0; i < allContents.count(); ++i)
+	{
+		const SectionContent::RefPtr sc = allContents.at(i).toStrongRef();
+		if (sc.isNull() || sc->containerWidget() != this)
+			continue;
+		if (contents.contains(sc))
+			continue;
+		leftContents.append(sc);
+	}
 
-	int fwCount = 0;
-	in >> fwCount;
-	if (fwCount <= 0)
-		return true;
+	// What should we do with a drunken sailor.. what should.. erm..
+	// What should we do with the left-contents?
+	// Lets add them to the first found SW or create one, if no SW is available.
+	for (int i = 0; i < leftContents.count(); ++i)
+	{
+		const SectionContent::RefPtr sc = leftContents.at(i);
+		SectionWidget* sw = NULL;
+
+		if (sections.isEmpty())
+		{
+			sw = new SectionWidget(this);
+			sections.append(sw);
+			addSection(sw);
+		}
+		else
+			sw = sections.first();
+
+		InternalContentData data;
+		if (!takeContent(sc, data))
+			sw->addContent(sc);
+		else
+			sw->addContent(data, false);
+	}
+}
 
-	for (int i = 0; i < fwCount; ++i)
+bool ContainerWidget::restoreFloatingWidgets(const QList<DockLayoutFloating>& data, QList<FloatingWidget*>& floatings)
+{
+	for (int i = 0; i < data.count(); ++i)
 	{
-		QString uname;
-		in >> uname;
-		QByteArray geom;
-		in >> geom;
-		bool visible = false;
-		in >> visible;
+		const DockLayoutFloating& f = data.at(i);
+		if (f.isTabbed())
+		{
+			FloatingWidget* fw = restoreTabbedFloatingWidget(f);
+			if (fw)
+				floatings.append(fw);
+			continue;
+		}
 
-		const SectionContent::RefPtr sc = SCLookupMapByName(this).value(uname).toStrongRef();
+		const SectionContent::RefPtr sc = SCLookupMapByName(this).value(f.uniqueName).toStrongRef();
 		if (!sc)
 		{
-			qWarning() << "Can not find SectionContent:" << uname;
+			qWarning() << "Can not find SectionContent:" << f.uniqueName;
 			continue;
 		}
 
-		InternalContentData data;
-		if (!this->takeContent(sc, data))
+		InternalContentData icd;
+		if (!this->takeContent(sc, icd))
 			continue;
 
-		FloatingWidget* fw = new FloatingWidget(this, sc, data.titleWidget, data.contentWidget, this);
-		fw->restoreGeometry(geom);
-		fw->setVisible(visible);
-		if (visible)
+		FloatingWidget* fw = newFloatingWidget(icd);
+		fw->restoreGeometry(f.geometry);
+		fw->setVisible(f.visible);
+		if (f.visible)
 		{
-			fw->_titleWidget->setVisible(visible);
-			fw->_contentWidget->setVisible(visible);
+			fw->_titleWidget->setVisible(f.visible);
+			fw->_contentWidget->setVisible(f.visible);
 		}
 		floatings.append(fw);
-		data.titleWidget->_fw = fw; // $mfreiholz: Don't look at it :-< It's more than ugly...
 	}
 	return true;
 }
 
-bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplitter* currentSplitter, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& contentsToHide)
+FloatingWidget* ContainerWidget::restoreTabbedFloatingWidget(const DockLayoutFloating& data)
 {
-	if (in.atEnd())
-		return true;
+	FloatingWidget* fw = NULL;
+	for (int i = 0; i < data.tabs.count(); ++i)
+	{
+		const SectionContent::RefPtr sc = SCLookupMapByName(this).value(data.tabs.at(i)).toStrongRef();
+		if (!sc)
+		{
+			qWarning() << "Can not find SectionContent:" << data.tabs.at(i);
+			continue;
+		}
 
-	int type;
-	in >> type;
+		InternalContentData icd;
+		if (!takeContent(sc, icd))
+			continue;
+		icd.titleWidget->setVisible(true);
+		icd.contentWidget->setVisible(true);
+
+		if (!fw)
+			fw = newFloatingWidget(icd);
+		else
+			fw->addContent(icd);
+	}
+	if (!fw)
+		return NULL;
+
+	if (fw->_section)
+		fw->_section->setCurrentIndex(data.currentIndex);
+	fw->restoreGeometry(data.geometry);
+	fw->setVisible(data.visible);
+	return fw;
+}
 
+bool ContainerWidget::restoreSectionWidgets(const DockLayoutNode& node, QSplitter* currentSplitter, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& contentsToHide)
+{
 	// Splitter
-	if (type == 1)
+	if (node.type == DockLayoutNode::SplitterNode)
 	{
-		int orientation, count;
-		QList<int> sizes;
-		in >> orientation >> count >> sizes;
-
-		QSplitter* sp = newSplitter((Qt::Orientation) orientation);
-		for (int i = 0; i < count; ++i)
+		QSplitter* sp = newSplitter(node.orientation);
+		for (int i = 0; i < node.children.count(); ++i)
 		{
-			if (!restoreSectionWidgets(in, version, sp, sections, contentsToHide))
+			if (!restoreSectionWidgets(node.children.at(i), sp, sections, contentsToHide))
 				return false;
 		}
 		if (sp->count() <= 0)
@@ -1144,7 +1473,7 @@ bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplit
 		}
 		else if (sp)
 		{
-			sp->setSizes(sizes);
+			sp->setSizes(node.sizes);
 
 			if (!currentSplitter)
 				_splitter = sp;
@@ -1153,7 +1482,7 @@ bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplit
 		}
 	}
 	// Section
-	else if (type == 2)
+	else if (node.type == DockLayoutNode::SectionNode)
 	{
 		if (!currentSplitter)
 		{
@@ -1161,23 +1490,15 @@ bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplit
 			return false;
 		}
 
-		int currentIndex, count;
-		in >> currentIndex >> count;
-
 		SectionWidget* sw = new SectionWidget(this);
-		for (int i = 0; i < count; ++i)
+		for (int i = 0; i < node.contents.count(); ++i)
 		{
-			QString uname;
-			in >> uname;
-			bool visible = false;
-			in >> visible;
-			int preferredIndex = -1;
-			in >> preferredIndex;
-
-			const SectionContent::RefPtr sc = SCLookupMapByName(this).value(uname).toStrongRef();
+			const DockLayoutContent& c = node.contents.at(i);
+
+			const SectionContent::RefPtr sc = SCLookupMapByName(this).value(c.uniqueName).toStrongRef();
 			if (!sc)
 			{
-				qWarning() << "Can not find SectionContent:" << uname;
+				qWarning() << "Can not find SectionContent:" << c.uniqueName;
 				continue;
 			}
 
@@ -1190,7 +1511,7 @@ bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplit
 			else
 				sw->addContent(data, false);
 
-			if (!visible)
+			if (!c.visible)
 				contentsToHide.append(sc);
 		}
 		if (sw->contents().isEmpty())
@@ -1200,48 +1521,423 @@ bool ContainerWidget::restoreSectionWidgets(QDataStream& in, int version, QSplit
 		}
 		else if (sw)
 		{
-			sw->setCurrentIndex(currentIndex);
+			sw->setCurrentIndex(node.currentIndex);
 			currentSplitter->addWidget(sw);
 			sections.append(sw);
 		}
 	}
-	// Unknown
-	else
+	return true;
+}
+
+bool ContainerWidget::restoreHierarchyIncremental(const QByteArray& data)
+{
+	DockLayoutTree tree;
+	if (!tree.fromByteArray(data))
+		return false;
+
+	// The incremental restore requires splitters and sections on both sides,
+	// everything else is handled by the complete rebuild.
+	QSplitter* rootSplitter = findImmediateSplitter(this);
+	if (!rootSplitter || _sections.isEmpty()
+			|| tree.root.type != DockLayoutNode::SplitterNode
+			|| !containsVisibleContent(tree.root, SCLookupMapByName(this)))
 	{
-		qWarning() << "Unknown object type during restore";
+		return restoreHierarchy(data);
 	}
 
+	// Existing splitters are reused in pre-order. For an unchanged tree
+	// every splitter is mapped onto itself and no widget gets reparented.
+	QList<QSplitter*> splitterPool;
+	collectSplitters(rootSplitter, splitterPool);
+
+	// Restore floating widgets, reuse the ones which already hold the content.
+	QList<FloatingWidget*> floatings;
+	for (int i = 0; i < tree.floatings.count(); ++i)
+	{
+		const DockLayoutFloating& f = tree.floatings.at(i);
+		if (f.isTabbed())
+		{
+			FloatingWidget* fw = restoreTabbedFloatingWidget(f);
+			if (fw)
+				floatings.append(fw);
+			continue;
+		}
+
+		const SectionContent::RefPtr sc = SCLookupMapByName(this).value(f.uniqueName).toStrongRef();
+		if (!sc)
+		{
+			qWarning() << "Can not find SectionContent:" << f.uniqueName;
+			continue;
+		}
+
+		FloatingWidget* fw = NULL;
+		const ContentLocation loc = _scLocationMapById.value(sc->uid());
+		if (loc.type == ContentLocation::FloatingLocation)
+		{
+			fw = loc.floating;
+		}
+		else
+		{
+			InternalContentData icd;
+			if (!takeContent(sc, icd))
+				continue;
+			fw = newFloatingWidget(icd);
+		}
+		fw->restoreGeometry(f.geometry);
+		fw->setVisible(f.visible);
+		if (f.visible)
+		{
+			fw->_titleWidget->setVisible(f.visible);
+			fw->_contentWidget->setVisible(f.visible);
+		}
+		floatings.append(fw);
+	}
+
+	// Restore splitters, sections and contents
+	QList<SectionWidget*> sections;
+	QList<SectionContent::RefPtr> hiddenContents;
+	QList<SectionContent::RefPtr> contentsToHide;
+	QList<QPair<QPointer<QSplitter>, QList<int> > > splitterSizes;
+	QSplitter* sp = qobject_cast<QSplitter*>(restoreSectionWidgetsIncremental(tree.root, splitterPool, sections, hiddenContents, splitterSizes));
+	if (sp != rootSplitter)
+	{
+		QLayoutItem* old = _mainLayout->takeAt(0);
+		_mainLayout->addWidget(sp);
+		delete old;
+	}
+	_splitter = sp;
+
+	// Restore lonely hidden contents
+	for (int i = 0; i < tree.hiddenContents.count(); ++i)
+	{
+		const SectionContent::RefPtr sc = SCLookupMapByName(this).value(tree.hiddenContents.at(i)).toStrongRef();
+		if (!sc)
+			continue;
+		if (_scLocationMapById.value(sc->uid()).type == ContentLocation::HiddenLocation)
+		{
+			_hiddenSectionContents[sc->uid()].preferredSectionId = -1;
+			hiddenContents.append(sc);
+			continue;
+		}
+
+		InternalContentData icd;
+		if (!takeContent(sc, icd))
+			continue;
+		sections.first()->addContent(icd, false);
+		contentsToHide.append(sc);
+	}
+
+	// Handle SectionContent which is not mentioned by deserialized data.
+	restoreLeftContents(floatings, sections, hiddenContents + contentsToHide);
+
+	// Delete no longer required objects, they don't hold any content anymore.
+	const QList<FloatingWidget*> oldFloatings = _floatings;
+	const QList<SectionWidget*> oldSections = _sections;
+	_floatings = floatings;
+	_sections = sections;
+	_sectionIndexDirty = true;
+	for (int i = 0; i < oldFloatings.count(); ++i)
+	{
+		if (!floatings.contains(oldFloatings.at(i)))
+			recycleFloatingWidget(oldFloatings.at(i));
+	}
+	for (int i = 0; i < oldSections.count(); ++i)
+	{
+		if (!sections.contains(oldSections.at(i)))
+			delete oldSections.at(i);
+	}
+
+	// Hide all as "hidden" marked contents
+	for (int i = 0; i < contentsToHide.count(); ++i)
+		hideSectionContent(contentsToHide.at(i));
+
+	// Sizes can only be applied after unused splitters are gone.
+	deleteEmptySplitter(this);
+	for (int i = 0; i < splitterSizes.count(); ++i)
+	{
+		QSplitter* s = splitterSizes.at(i).first;
+		if (s)
+			s->setSizes(splitterSizes.at(i).second);
+	}
 	return true;
 }
 
+QWidget* ContainerWidget::restoreSectionWidgetsIncremental(const DockLayoutNode& node, QList<QSplitter*>& splitterPool, QList<SectionWidget*>& sections, QList<SectionContent::RefPtr>& hiddenContents, QList<QPair<QPointer<QSplitter>, QList<int> > >& splitterSizes)
+{
+	// Splitter
+	if (node.type == DockLayoutNode::SplitterNode)
+	{
+		QSplitter* sp = splitterPool.isEmpty() ? newSplitter(node.orientation) : splitterPool.takeFirst();
+		sp->setOrientation(node.orientation);
+
+		// Children are complete, before they get moved into this splitter.
+		QList<int> sizes;
+		int index = 0;
+		for (int i = 0; i < node.children.count(); ++i)
+		{
+			QWidget* w = restoreSectionWidgetsIncremental(node.children.at(i), splitterPool, sections, hiddenContents, splitterSizes);
+			if (!w)
+				continue;
+			if (sp->indexOf(w) != index)
+				sp->insertWidget(index, w);
+			sizes.append(node.sizes.value(i));
+			++index;
+		}
+		if (index == 0)
+			return NULL;
+		splitterSizes.append(qMakePair(QPointer<QSplitter>(sp), sizes));
+		return sp;
+	}
+	// Section
+	else if (node.type == DockLayoutNode::SectionNode)
+	{
+		// Reuse the section, which currently holds the first visible content.
+		SectionWidget* sw = NULL;
+		for (int i = 0; i < node.contents.count() && !sw; ++i)
+		{
+			if (!node.contents.at(i).visible)
+				continue;
+			const SectionContent::RefPtr sc = SCLookupMapByName(this).value(node.contents.at(i).uniqueName).toStrongRef();
+			if (!sc)
+				continue;
+			const ContentLocation loc = _scLocationMapById.value(sc->uid());
+			if (loc.type == ContentLocation::SectionLocation && !sections.contains(loc.section))
+				sw = loc.section;
+		}
+		if (!sw)
+			sw = new SectionWidget(this);
+		sections.append(sw);
+
+		int index = 0;
+		for (int i = 0; i < node.contents.count(); ++i)
+		{
+			const DockLayoutContent& c = node.contents.at(i);
+			const SectionContent::RefPtr sc = SCLookupMapByName(this).value(c.uniqueName).toStrongRef();
+			if (!sc)
+			{
+				qWarning() << "Can not find SectionContent:" << c.uniqueName;
+				continue;
+			}
+
+			const ContentLocation loc = _scLocationMapById.value(sc->uid());
+
+			// Hidden contents are directly associated with this section.
+			if (!c.visible)
+			{
+				if (loc.type != ContentLocation::HiddenLocation)
+				{
+					const bool visibleBefore = loc.type == ContentLocation::SectionLocation
+							|| (loc.type == ContentLocation::FloatingLocation && loc.floating->isVisible());
+					HiddenSectionItem hsi;
+					if (!takeContent(sc, hsi.data))
+						continue;
+					hsi.data.titleWidget->setVisible(false);
+					hsi.data.contentWidget->setVisible(false);
+					_hiddenSectionContents.insert(sc->uid(), hsi);
+					_scLocationMapById[sc->uid()].type = ContentLocation::HiddenLocation;
+					emitSectionContentVisibilityChanged(sc, visibleBefore, false);
+				}
+				HiddenSectionItem& hsi = _hiddenSectionContents[sc->uid()];
+				hsi.preferredSectionId = sw->uid();
+				hsi.preferredSectionIndex = c.preferredIndex;
+				invalidateLayoutTree();
+				hiddenContents.append(sc);
+				continue;
+			}
+
+			// Move the content into this section, if it isn't already there.
+			if (loc.type != ContentLocation::SectionLocation || loc.section != sw)
+			{
+				InternalContentData data;
+				if (!takeContent(sc, data))
+				{
+					qCritical() << "Can not find InternalContentData of SC, this should never happen!" << sc->uid() << sc->uniqueName();
+					sw->addContent(sc);
+				}
+				else
+					sw->addContent(data, false);
+
+				if (loc.type == ContentLocation::HiddenLocation)
+					emitSectionContentVisibilityChanged(sc, false, true);
+			}
+
+			const int from = sw->indexOfContentByUid(sc->uid());
+			if (from != index)
+				sw->moveContent(from, index);
+			++index;
+		}
+
+		if (sw->contents().isEmpty())
+		{
+			sections.removeAll(sw);
+			if (!_sections.contains(sw))
+				delete sw;
+			return NULL;
+		}
+		sw->setCurrentIndex(node.currentIndex);
+		return sw;
+	}
+	return NULL;
+}
+
 bool ContainerWidget::takeContent(const SectionContent::RefPtr& sc, InternalContentData& data)
 {
 	ADS_Expects(!sc.isNull());
 
-	// Search in sections
-	bool found = false;
-	for (int i = 0; i < _sections.count() && !found; ++i)
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+	switch (loc.type)
+	{
+	case ContentLocation::SectionLocation:
+		return loc.section->takeContent(sc->uid(), data);
+	case ContentLocation::FloatingLocation:
+		return loc.floating->takeContent(data);
+	case ContentLocation::HiddenLocation:
 	{
-		found = _sections.at(i)->takeContent(sc->uid(), data);
+		const HiddenSectionItem hsi = _hiddenSectionContents.take(sc->uid());
+		_scLocationMapById.remove(sc->uid());
+		invalidateLayoutTree();
+		data = hsi.data;
+		return true;
 	}
+	default:
+		break;
+	}
+	return false;
+}
 
-	// Search in floating widgets
-	for (int i = 0; i < _floatings.count() && !found; ++i)
+// Collapses empty splitters beginning at "splitter" or runs a full pass, if "splitter" is NULL.
+void ContainerWidget::deleteEmptySplitterDeferred(QSplitter* splitter)
+{
+	if (isUpdating())
 	{
-		found = _floatings.at(i)->content()->uid() == sc->uid();
-		if (found)
-			_floatings.at(i)->takeContent(data);
+		if (splitter)
+			_pendingEmptySplitters.append(splitter);
+		else
+			_deleteEmptySplitterPending = true;
 	}
+	else if (splitter)
+		deleteEmptySplitter(splitter);
+	else
+		deleteEmptySplitter(this);
+}
+
+void ContainerWidget::emitSectionContentVisibilityChanged(const SectionContent::RefPtr& sc, bool visibleBefore, bool visible)
+{
+	recordSectionContentChange(sc, true, visibleBefore, visible);
 
-	// Search in hidden items
-	if (!found && _hiddenSectionContents.contains(sc->uid()))
+	if (!isUpdating())
 	{
-		const HiddenSectionItem hsi = _hiddenSectionContents.take(sc->uid());
-		data = hsi.data;
-		found = true;
+		emit sectionContentVisibilityChanged(sc, visible);
+		return;
+	}
+
+	// Remember the state before the first change, the last change wins.
+	if (!_pendingVisibilityChanges.contains(sc->uid()))
+	{
+		PendingVisibilityChange pvc;
+		pvc.content = sc;
+		pvc.visibleBefore = visibleBefore;
+		_pendingVisibilityUids.append(sc->uid());
+		_pendingVisibilityChanges.insert(sc->uid(), pvc);
+	}
+	_pendingVisibilityChanges[sc->uid()].visible = visible;
+}
+
+bool ContainerWidget::isSectionContentActive(const SectionContent::RefPtr& sc) const
+{
+	const ContentLocation loc = _scLocationMapById.value(sc->uid());
+	if (loc.type != ContentLocation::SectionLocation)
+		return false;
+	SectionTitleWidget* stw = loc.section->_sectionTitles.value(loc.index);
+	return stw && stw->isActiveTab();
+}
+
+// Records a change of the visibility (or "isActiveTab" state) of "sc", which is delivered later
+// by a single sectionContentsChanged() signal. The first record of a content remembers "valueBefore".
+void ContainerWidget::recordSectionContentChange(const SectionContent::RefPtr& sc, bool visibility, bool valueBefore, bool value)
+{
+	if (!_contentsChangedEnabled)
+		return;
+
+	if (!_changedContents.contains(sc->uid()))
+	{
+		SectionContentChange c;
+		c.content = sc;
+		if (visibility)
+		{
+			c.visibleBefore = valueBefore;
+			c.activeBefore = c.active = isSectionContentActive(sc);
+		}
+		else
+		{
+			const ContentLocation loc = _scLocationMapById.value(sc->uid());
+			c.visibleBefore = c.visible = loc.type == ContentLocation::SectionLocation
+					|| (loc.type == ContentLocation::FloatingLocation && loc.floating->isVisible());
+			c.activeBefore = valueBefore;
+		}
+		_changedContentUids.append(sc->uid());
+		_changedContents.insert(sc->uid(), c);
+	}
+
+	SectionContentChange& c = _changedContents[sc->uid()];
+	if (visibility)
+		c.visible = value;
+	else
+		c.active = value;
+
+	// Outside of a batch, deliver once per event loop iteration.
+	if (!isUpdating() && !_contentsChangedFlushScheduled)
+	{
+		_contentsChangedFlushScheduled = true;
+		QMetaObject::invokeMethod(this, "flushSectionContentChanges", Qt::QueuedConnection);
+	}
+}
+
+// Marks the content as most recently used, called whenever its widget gets loaded, shown or hidden.
+void ContainerWidget::touchHibernation(int uid, bool visible)
+{
+	const SectionContent::RefPtr sc = SCLookupMapById(this).value(uid).toStrongRef();
+	if (sc.isNull() || !sc->_contentFactory || !sc->isContentWidgetLoaded())
+		return;
+
+	_hibernationLru.removeAll(uid);
+	_hibernationLru.append(uid);
+	if (visible)
+		_hibernationInactiveSince.remove(uid);
+	else
+		_hibernationInactiveSince.insert(uid, QDateTime::currentMSecsSinceEpoch());
+
+	enforceHibernationBudget();
+}
+
+void ContainerWidget::enforceHibernationBudget()
+{
+	if (_hibernationBudget <= 0)
+		return;
+
+	QList<int> costs;
+	int cost = 0;
+	for (int i = 0; i < _hibernationLru.count(); ++i)
+	{
+		const SectionContent::RefPtr sc = SCLookupMapById(this).value(_hibernationLru.at(i)).toStrongRef();
+		costs.append(sc ? sc->_contentFactory->contentCost(sc->uniqueName(), sc->_contentWidget) : 0);
+		cost += costs.last();
 	}
 
-	return found;
+	// Unload least recently used contents first, the most recent one always stays.
+	for (int i = 0; i < _hibernationLru.count() - 1 && cost > _hibernationBudget; )
+	{
+		const SectionContent::RefPtr sc = SCLookupMapById(this).value(_hibernationLru.at(i)).toStrongRef();
+		if (sc.isNull())
+		{
+			_hibernationLru.removeAt(i);
+			cost -= costs.takeAt(i);
+		}
+		else if (hibernateSectionContent(sc))
+			cost -= costs.takeAt(i);
+		else
+			++i;
+	}
 }
 
 void ContainerWidget::onActiveTabChanged()
@@ -1250,6 +1946,46 @@ void ContainerWidget::onActiveTabChanged()
 	if (stw)
 	{
 		emit activeTabChanged(stw->_content, stw->isActiveTab());
+		recordSectionContentChange(stw->_content, false, !stw->isActiveTab(), stw->isActiveTab());
+	}
+}
+
+void ContainerWidget::flushSectionContentChanges()
+{
+	_contentsChangedFlushScheduled = false;
+	if (isUpdating() || _changedContentUids.isEmpty())
+		return;
+
+	const QList<int> uids = _changedContentUids;
+	const QHash<int, SectionContentChange> changes = _changedContents;
+	_changedContentUids.clear();
+	_changedContents.clear();
+
+	QList<SectionContentChange> effectiveChanges;
+	for (int i = 0; i < uids.count(); ++i)
+	{
+		const SectionContentChange& c = changes[uids.at(i)];
+		if (c.visible != c.visibleBefore || c.active != c.activeBefore)
+			effectiveChanges.append(c);
+	}
+	if (!effectiveChanges.isEmpty())
+		emit sectionContentsChanged(effectiveChanges);
+}
+
+void ContainerWidget::onHibernationTimeout()
+{
+	if (_hibernationTimeout <= 0)
+		return;
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	const QList<int> uids = _hibernationInactiveSince.keys();
+	for (int i = 0; i < uids.count(); ++i)
+	{
+		if (now - _hibernationInactiveSince.value(uids.at(i)) < _hibernationTimeout)
+			continue;
+		const SectionContent::RefPtr sc = SCLookupMapById(this).value(uids.at(i)).toStrongRef();
+		if (sc.isNull() || !hibernateSectionContent(sc))
+			_hibernationInactiveSince.remove(uids.at(i));
 	}
 }
 
@@ -0,0 +1,402 @@
+#include "ads/DockLayoutGeometry.h"
+
+#include <QVector>
+#include <QWidget>
+
+#include <algorithm>
+
+ADS_NAMESPACE_BEGIN
+
+// Static Helper //////////////////////////////////////////////////////
+
+/*
+	One item of a splitter chain (a handle or a child), same as QLayoutStruct.
+*/
+class GeometryItem
+{
+public:
+	GeometryItem() :
+		stretch(0),
+		sizeHint(0),
+		maximumSize(QWIDGETSIZE_MAX),
+		minimumSize(0),
+		expansive(false),
+		empty(true),
+		done(false),
+		pos(0),
+		size(0)
+	{}
+
+	int smartSizeHint() const { return (stretch > 0) ? minimumSize : sizeHint; }
+
+	int stretch;
+	int sizeHint;
+	int maximumSize;
+	int minimumSize;
+	bool expansive;
+	bool empty;
+	bool done;
+	int pos;
+	int size;
+};
+
+typedef qint64 Fixed64;
+static inline Fixed64 toFixed(int i) { return (Fixed64) i * 256; }
+static inline int fRound(Fixed64 i) { return (i % 256 < 128) ? i / 256 : 1 + i / 256; }
+
+/*
+	Distributes <em>space</em> to the items of <em>chain</em>, exactly as
+	qGeomCalc() of the Qt layout engine does for QSplitter (no spacing).
+*/
+static void geomCalc(QVector<GeometryItem>& chain, int pos, int space)
+{
+	const int count = chain.count();
+	int cHint = 0;
+	int cMin = 0;
+	int sumStretch = 0;
+	int expandingCount = 0;
+	bool allEmptyNonstretch = true;
+	int nonEmptyCount = 0;
+	int i;
+
+	for (i = 0; i < count; ++i)
+	{
+		GeometryItem& data = chain[i];
+		data.done = false;
+		if (!data.empty)
+			nonEmptyCount++;
+		cHint += data.smartSizeHint();
+		cMin += data.minimumSize;
+		sumStretch += data.stretch;
+		if (data.expansive)
+			expandingCount++;
+		allEmptyNonstretch = allEmptyNonstretch && data.empty && !data.expansive && data.stretch <= 0;
+	}
+
+	int extraspace = 0;
+
+	if (space < cMin)
+	{
+		// Less space than minimum size, take from the biggest first.
+		QVector<int> minimumSizes;
+		minimumSizes.reserve(count);
+		for (i = 0; i < count; ++i)
+			minimumSizes.append(chain.at(i).minimumSize);
+		std::sort(minimumSizes.begin(), minimumSizes.end());
+
+		int sum = 0;
+		int idx = 0;
+		int spaceUsed = 0;
+		int current = 0;
+		while (idx < count && spaceUsed < space)
+		{
+			current = minimumSizes.at(idx);
+			spaceUsed = sum + current * (count - idx);
+			sum += current;
+			++idx;
+		}
+		--idx;
+		const int deficit = spaceUsed - space;
+		const int items = count - idx;
+		const int deficitPerItem = deficit / items;
+		const int remainder = deficit % items;
+		const int maxval = current - deficitPerItem;
+
+		int rest = 0;
+		for (i = 0; i < count; ++i)
+		{
+			int maxv = maxval;
+			rest += remainder;
+			if (rest >= items)
+			{
+				maxv--;
+				rest -= items;
+			}
+			GeometryItem& data = chain[i];
+			data.size = qMin(data.minimumSize, maxv);
+			data.done = true;
+		}
+	}
+	else if (space < cHint)
+	{
+		// Less space than size hint, take equally from each item.
+		int n = count;
+		int overdraft = cHint - space;
+
+		for (i = 0; i < count; ++i)
+		{
+			GeometryItem& data = chain[i];
+			if (!data.done && data.minimumSize >= data.smartSizeHint())
+			{
+				data.size = data.smartSizeHint();
+				data.done = true;
+				n--;
+			}
+		}
+		bool finished = n == 0;
+		while (!finished)
+		{
+			finished = true;
+			const Fixed64 fpOver = toFixed(overdraft);
+			Fixed64 fpW = 0;
+			for (i = 0; i < count; ++i)
+			{
+				GeometryItem& data = chain[i];
+				if (data.done)
+					continue;
+				fpW += fpOver / n;
+				const int w = fRound(fpW);
+				data.size = data.smartSizeHint() - w;
+				fpW -= toFixed(w);
+				if (data.size < data.minimumSize)
+				{
+					data.done = true;
+					data.size = data.minimumSize;
+					finished = false;
+					overdraft -= data.smartSizeHint() - data.minimumSize;
+					n--;
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		// Extra space, distribute it by stretch.
+		int n = count;
+		int spaceLeft = space;
+		for (i = 0; i < count; ++i)
+		{
+			GeometryItem& data = chain[i];
+			if (!data.done
+					&& (data.maximumSize <= data.smartSizeHint()
+						|| (!allEmptyNonstretch && data.empty && !data.expansive && data.stretch == 0)))
+			{
+				data.size = data.smartSizeHint();
+				data.done = true;
+				spaceLeft -= data.size;
+				sumStretch -= data.stretch;
+				if (data.expansive)
+					expandingCount--;
+				n--;
+			}
+		}
+		extraspace = spaceLeft;
+
+		// Trial distribution, then fix items below their hint or above their
+		// maximum and repeat, until nothing is off anymore.
+		int surplus, deficit;
+		do
+		{
+			surplus = deficit = 0;
+			const Fixed64 fpSpace = toFixed(spaceLeft);
+			Fixed64 fpW = 0;
+			for (i = 0; i < count; ++i)
+			{
+				GeometryItem& data = chain[i];
+				if (data.done)
+					continue;
+				extraspace = 0;
+				if (sumStretch > 0)
+					fpW += (fpSpace * data.stretch) / sumStretch;
+				else if (expandingCount > 0)
+					fpW += (fpSpace * (data.expansive ? 1 : 0)) / expandingCount;
+				else
+					fpW += fpSpace / n;
+				const int w = fRound(fpW);
+				data.size = w;
+				fpW -= toFixed(w);
+				if (w < data.smartSizeHint())
+					deficit += data.smartSizeHint() - w;
+				else if (w > data.maximumSize)
+					surplus += w - data.maximumSize;
+			}
+			if (deficit > 0 && surplus <= deficit)
+			{
+				for (i = 0; i < count; ++i)
+				{
+					GeometryItem& data = chain[i];
+					if (!data.done && data.size < data.smartSizeHint())
+					{
+						data.size = data.smartSizeHint();
+						data.done = true;
+						spaceLeft -= data.smartSizeHint();
+						sumStretch -= data.stretch;
+						if (data.expansive)
+							expandingCount--;
+						n--;
+					}
+				}
+			}
+			if (surplus > 0 && surplus >= deficit)
+			{
+				for (i = 0; i < count; ++i)
+				{
+					GeometryItem& data = chain[i];
+					if (!data.done && data.size > data.maximumSize)
+					{
+						data.size = data.maximumSize;
+						data.done = true;
+						spaceLeft -= data.maximumSize;
+						sumStretch -= data.stretch;
+						if (data.expansive)
+							expandingCount--;
+						n--;
+					}
+				}
+			}
+		}
+		while (n > 0 && surplus != deficit);
+		if (n == 0)
+			extraspace = spaceLeft;
+	}
+
+	// Unwanted space goes equally into the gaps between the items,
+	// including the start and end of the chain.
+	const int extra = extraspace / (qMax(nonEmptyCount - 1, 0) + 2);
+	int p = pos + extra;
+	for (i = 0; i < count; ++i)
+	{
+		GeometryItem& data = chain[i];
+		data.pos = p;
+		p += data.size;
+		if (!data.empty)
+			p += extra;
+	}
+}
+
+/*
+	Returns whether the node results in a visible widget after a restore.
+	Sections without visible contents are not created.
+*/
+static bool isVisibleNode(const DockLayoutNode& node)
+{
+	if (node.type == DockLayoutNode::SectionNode)
+	{
+		for (int i = 0; i < node.contents.count(); ++i)
+		{
+			if (node.contents.at(i).visible)
+				return true;
+		}
+		return false;
+	}
+	else if (node.type == DockLayoutNode::SplitterNode)
+	{
+		for (int i = 0; i < node.children.count(); ++i)
+		{
+			if (isVisibleNode(node.children.at(i)))
+				return true;
+		}
+	}
+	return false;
+}
+
+static inline int pick(Qt::Orientation o, const QSize& s) { return o == Qt::Horizontal ? s.width() : s.height(); }
+static inline int trans(Qt::Orientation o, const QSize& s) { return o == Qt::Horizontal ? s.height() : s.width(); }
+
+static void calcSectionGeometries(const DockLayoutNode& node, const QRect& rect, int handleWidth, const QSize& minimumSectionSize, QList<QRect>& rects)
+{
+	if (node.type == DockLayoutNode::SectionNode)
+	{
+		rects.append(rect);
+		return;
+	}
+
+	// Chain of (handle, child) pairs, like QSplitterPrivate::doResize() builds it.
+	// The handle in front of the first visible child is hidden.
+	const Qt::Orientation o = node.orientation;
+	QVector<GeometryItem> chain;
+	QList<int> childIndexes;
+	for (int i = 0; i < node.children.count(); ++i)
+	{
+		const DockLayoutNode& child = node.children.at(i);
+		if (!isVisibleNode(child))
+			continue;
+
+		GeometryItem handle;
+		if (childIndexes.isEmpty())
+		{
+			handle.maximumSize = 0;
+		}
+		else
+		{
+			handle.sizeHint = handle.minimumSize = handle.maximumSize = handleWidth;
+			handle.empty = false;
+		}
+		chain.append(handle);
+
+		const int size = node.sizes.value(i, 0);
+		GeometryItem item;
+		if (size <= 0)
+		{
+			// Collapsed
+			item.maximumSize = 0;
+		}
+		else
+		{
+			item.minimumSize = pick(o, DockLayoutGeometry::minimumSize(child, handleWidth, minimumSectionSize));
+			item.stretch = qMax(size, item.minimumSize);
+			item.sizeHint = item.minimumSize;
+			item.expansive = true;
+			item.empty = false;
+		}
+		chain.append(item);
+		childIndexes.append(i);
+	}
+
+	if (chain.isEmpty())
+		return;
+
+	geomCalc(chain, pick(o, QSize(rect.x(), rect.y())), pick(o, rect.size()));
+
+	for (int i = 0; i < childIndexes.count(); ++i)
+	{
+		const GeometryItem& item = chain.at(i * 2 + 1);
+		const QRect childRect = (o == Qt::Horizontal)
+				? QRect(item.pos, rect.y(), item.size, rect.height())
+				: QRect(rect.x(), item.pos, rect.width(), item.size);
+		calcSectionGeometries(node.children.at(childIndexes.at(i)), childRect, handleWidth, minimumSectionSize, rects);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////
+
+QList<QRect> DockLayoutGeometry::sectionGeometries(const DockLayoutNode& node, const QRect& rect, int handleWidth, const QSize& minimumSectionSize)
+{
+	QList<QRect> rects;
+	if (isVisibleNode(node))
+		calcSectionGeometries(node, rect, handleWidth, minimumSectionSize, rects);
+	return rects;
+}
+
+QSize DockLayoutGeometry::minimumSize(const DockLayoutNode& node, int handleWidth, const QSize& minimumSectionSize)
+{
+	if (node.type == DockLayoutNode::SectionNode)
+		return minimumSectionSize;
+	else if (node.type != DockLayoutNode::SplitterNode)
+		return QSize();
+
+	const Qt::Orientation o = node.orientation;
+	int l = 0;
+	int t = 0;
+	bool first = true;
+	for (int i = 0; i < node.children.count(); ++i)
+	{
+		const DockLayoutNode& child = node.children.at(i);
+		if (!isVisibleNode(child))
+			continue;
+
+		const QSize s = minimumSize(child, handleWidth, minimumSectionSize);
+		l += pick(o, s);
+		t = qMax(t, trans(o, s));
+		if (!first)
+		{
+			l += handleWidth;
+			t = qMax(t, handleWidth);
+		}
+		first = false;
+	}
+	return o == Qt::Horizontal ? QSize(l, t) : QSize(t, l);
+}
+
+ADS_NAMESPACE_END
@@ -0,0 +1,330 @@
+#include "ads/DockLayoutTree.h"
+
+#include <QDebug>
+#include <QDataStream>
+
+#include "ads/Serialization.h"
+
+ADS_NAMESPACE_BEGIN
+
+// Static Helper //////////////////////////////////////////////////////
+
+static bool readNode(QDataStream& in, DockLayoutNode& node)
+{
+	if (in.atEnd())
+		return true;
+
+	int type = DockLayoutNode::InvalidNode;
+	in >> type;
+
+	// Splitter
+	if (type == DockLayoutNode::SplitterNode)
+	{
+		int orientation = 0, count = 0;
+		in >> orientation >> count >> node.sizes;
+
+		node.type = DockLayoutNode::SplitterNode;
+		node.orientation = (Qt::Orientation) orientation;
+		for (int i = 0; i < count; ++i)
+		{
+			DockLayoutNode child;
+			if (!readNode(in, child))
+				return false;
+			if (child.isValid())
+				node.children.append(child);
+		}
+	}
+	// Section
+	else if (type == DockLayoutNode::SectionNode)
+	{
+		int currentIndex = 0, count = 0;
+		in >> currentIndex >> count;
+
+		node.type = DockLayoutNode::SectionNode;
+		node.currentIndex = currentIndex;
+		for (int i = 0; i < count; ++i)
+		{
+			DockLayoutContent c;
+			in >> c.uniqueName >> c.visible >> c.preferredIndex;
+			node.contents.append(c);
+		}
+	}
+	// Unknown
+	else if (type != DockLayoutNode::InvalidNode)
+	{
+		qWarning() << "Unknown object type during restore";
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+// The fields of a floating widget depend on the format version (see DockLayoutTree::toByteArray()).
+static void writeFloating(QDataStream& out, const DockLayoutFloating& floating, quint32 version)
+{
+	out << floating.uniqueName;
+	out << floating.geometry;
+	out << floating.visible;
+	if (version >= 2)
+	{
+		out << floating.tabs;
+		out << floating.currentIndex;
+	}
+}
+
+static void readFloating(QDataStream& in, DockLayoutFloating& floating, quint32 version)
+{
+	in >> floating.uniqueName >> floating.geometry >> floating.visible;
+	if (version >= 2)
+		in >> floating.tabs >> floating.currentIndex;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+DockLayoutContent::DockLayoutContent() :
+	visible(false),
+	preferredIndex(-1)
+{
+}
+
+DockLayoutContent::DockLayoutContent(const QString& uniqueName, bool visible, int preferredIndex) :
+	uniqueName(uniqueName),
+	visible(visible),
+	preferredIndex(preferredIndex)
+{
+}
+
+bool DockLayoutContent::operator==(const DockLayoutContent& other) const
+{
+	return uniqueName == other.uniqueName
+			&& visible == other.visible
+			&& preferredIndex == other.preferredIndex;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+DockLayoutNode::DockLayoutNode() :
+	type(InvalidNode),
+	orientation(Qt::Horizontal),
+	currentIndex(-1),
+	sectionId(-1)
+{
+}
+
+int DockLayoutNode::sectionCount() const
+{
+	if (type == SectionNode)
+		return 1;
+
+	int count = 0;
+	for (int i = 0; i < children.count(); ++i)
+		count += children.at(i).sectionCount();
+	return count;
+}
+
+bool DockLayoutNode::operator==(const DockLayoutNode& other) const
+{
+	if (type != other.type)
+		return false;
+
+	switch (type)
+	{
+	case SplitterNode:
+		return orientation == other.orientation
+				&& sizes == other.sizes
+				&& children == other.children;
+	case SectionNode:
+		return currentIndex == other.currentIndex
+				&& contents == other.contents;
+	default:
+		return true;
+	}
+}
+
+QDataStream& operator<<(QDataStream& out, const DockLayoutNode& node)
+{
+	switch (node.type)
+	{
+	case DockLayoutNode::SplitterNode:
+		out << (int) DockLayoutNode::SplitterNode;
+		out << ((node.orientation == Qt::Horizontal) ? (int) 1 : (int) 2);
+		out << node.children.count();
+		out << node.sizes;
+		for (int i = 0; i < node.children.count(); ++i)
+		{
+			out << node.children.at(i);
+		}
+		break;
+	case DockLayoutNode::SectionNode:
+		out << (int) DockLayoutNode::SectionNode;
+		out << node.currentIndex;
+		out << node.contents.count();
+		for (int i = 0; i < node.contents.count(); ++i)
+		{
+			const DockLayoutContent& c = node.contents.at(i);
+			out << c.uniqueName;
+			out << c.visible;
+			out << c.preferredIndex;
+		}
+		break;
+	default:
+		out << (int) DockLayoutNode::InvalidNode;
+		break;
+	}
+	return out;
+}
+
+///////////////////////////////////////////////////////////////////////
+
+DockLayoutFloating::DockLayoutFloating() :
+	visible(false),
+	currentIndex(-1)
+{
+}
+
+bool DockLayoutFloating::operator==(const DockLayoutFloating& other) const
+{
+	return uniqueName == other.uniqueName
+			&& geometry == other.geometry
+			&& visible == other.visible
+			&& tabs == other.tabs
+			&& (tabs.isEmpty() || currentIndex == other.currentIndex);
+}
+
+///////////////////////////////////////////////////////////////////////
+
+DockLayoutTree::DockLayoutTree()
+{
+}
+
+bool DockLayoutTree::operator==(const DockLayoutTree& other) const
+{
+	return floatings == other.floatings
+			&& root == other.root
+			&& hiddenContents == other.hiddenContents;
+}
+
+QByteArray DockLayoutTree::toByteArray() const
+{
+	/*
+		# Data Format
+
+		quint32                   Magic
+		quint32                   Version (2 if there are tabbed floating widgets, otherwise 1)
+
+		int                       Number of floating widgets
+		LOOP                      Floating widgets
+			QString               Unique name of content
+			QByteArray            Geometry of floating widget
+			bool                  Visibility
+			IF Version >= 2
+				QStringList       Unique names of the tabs (empty for a single content)
+				int               Current tab
+			ENDIF
+
+		int                       Number of layout items (Valid values: 0, 1)
+		IF 0
+			int                   Number of hidden contents
+			LOOP                  Contents
+				QString           Unique name of content
+		ELSEIF 1
+			Node                  Root splitter (see operator<<(QDataStream&, const DockLayoutNode&))
+			int                   Number of hidden contents without section association
+			LOOP                  Contents
+				QString           Unique name of content
+		ENDIF
+	*/
+	QByteArray ba;
+	QDataStream out(&ba, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_4_5);
+	// Version 1 as long as possible, older readers can still restore it.
+	quint32 version = 1;
+	for (int i = 0; i < floatings.count(); ++i)
+	{
+		if (floatings.at(i).isTabbed())
+			version = 2;
+	}
+
+	out << (quint32) 0x00001337; // Magic
+	out << version;
+
+	out << floatings.count();
+	for (int i = 0; i < floatings.count(); ++i)
+	{
+		writeFloating(out, floatings.at(i), version);
+	}
+
+	out << (root.isValid() ? 1 : 0); // Mode
+	if (root.isValid())
+	{
+		out << root;
+	}
+	out << hiddenContents.count();
+	for (int i = 0; i < hiddenContents.count(); ++i)
+	{
+		out << hiddenContents.at(i);
+	}
+	return ba;
+}
+
+bool DockLayoutTree::fromByteArray(const QByteArray& data)
+{
+	*this = DockLayoutTree();
+
+	QDataStream in(data);
+	in.setVersion(QDataStream::Qt_4_5);
+
+	quint32 magic = 0;
+	in >> magic;
+	if (magic != 0x00001337)
+		return false;
+
+	quint32 version = 0;
+	in >> version;
+	if (version != 1 && version != 2)
+		return false;
+
+	int fwCount = 0;
+	in >> fwCount;
+	for (int i = 0; i < fwCount; ++i)
+	{
+		DockLayoutFloating f;
+		readFloating(in, f, version);
+		floatings.append(f);
+	}
+
+	int mode = 0;
+	in >> mode;
+	if (mode == 1)
+	{
+		if (!readNode(in, root))
+			return false;
+	}
+	else if (mode != 0)
+	{
+		qWarning() << "Invalid hierarchy mode" << mode;
+		return false;
+	}
+
+	int cnt = 0;
+	in >> cnt;
+	for (int i = 0; i < cnt; ++i)
+	{
+		QString uname;
+		in >> uname;
+		hiddenContents.append(uname);
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+bool DockLayoutTree::fromState(const QByteArray& state)
+{
+	ADS_NS_SER::InMemoryReader reader(state);
+	if (!reader.initReadHeader())
+		return false;
+
+	QByteArray hierarchyData;
+	if (!reader.read(ADS_NS_SER::ET_Hierarchy, hierarchyData))
+		return false;
+	return fromByteArray(hierarchyData);
+}
+
+ADS_NAMESPACE_END
@@ -1,31 +1,37 @@
 #include "ads/DropOverlay.h"
 
 #include <QPointer>
+#include <QDebug>
 #include <QPaintEvent>
 #include <QResizeEvent>
 #include <QMoveEvent>
 #include <QPainter>
+#include <QRegion>
 #include <QGridLayout>
 #include <QCursor>
 #include <QIcon>
 #include <QLabel>
+#include <QPixmapCache>
 
 ADS_NAMESPACE_BEGIN
 
 // Helper /////////////////////////////////////////////////////////////
 
-static QPixmap createDropIndicatorPixmap(const QPalette& pal, const QSizeF& size, DropArea dropArea)
+static QPixmap createDropIndicatorPixmap(const QPalette& pal, const QSizeF& size, DropArea dropArea, qreal devicePixelRatio)
 {
 	const QColor borderColor = pal.color(QPalette::Active, QPalette::Highlight);
 	const QColor backgroundColor = pal.color(QPalette::Active, QPalette::Base);
 	const QColor areaBackgroundColor = pal.color(QPalette::Active, QPalette::Highlight).lighter(150);
 
-	QPixmap pm(size.width(), size.height());
+	QPixmap pm(size.width() * devicePixelRatio, size.height() * devicePixelRatio);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	pm.setDevicePixelRatio(devicePixelRatio);
+#endif
 	pm.fill(QColor(0, 0, 0, 0));
 
 	QPainter p(&pm);
 	QPen pen = p.pen();
-	QRectF baseRect(pm.rect());
+	QRectF baseRect(QPointF(0, 0), size);
 
 	// Fill
 	p.fillRect(baseRect, backgroundColor);
@@ -102,22 +108,126 @@ static QPixmap createDropIndicatorPixmap(const QPalette& pal, const QSizeF& size
 	return pm;
 }
 
-static QWidget* createDropIndicatorWidget(DropArea dropArea)
+/*
+	Returns the indicator pixmap from the process-wide QPixmapCache. All
+	inputs of the painting are part of the key, so each indicator is painted
+	once and shared by the overlays of all containers.
+*/
+static QPixmap dropIndicatorPixmap(const QPalette& pal, const QSizeF& size, DropArea dropArea, qreal devicePixelRatio)
+{
+	const QString key = QString("ads_dropindicator_%1_%2x%3_%4_%5_%6")
+			.arg((int) dropArea)
+			.arg(size.width())
+			.arg(size.height())
+			.arg(devicePixelRatio)
+			.arg(pal.color(QPalette::Active, QPalette::Highlight).rgba())
+			.arg(pal.color(QPalette::Active, QPalette::Base).rgba());
+
+	QPixmap pm;
+	if (!QPixmapCache::find(key, &pm))
+	{
+		pm = createDropIndicatorPixmap(pal, size, dropArea, devicePixelRatio);
+		QPixmapCache::insert(key, pm);
+	}
+	return pm;
+}
+
+/*
+	Label of a drop area. It fetches its pixmap again, when the palette or
+	font changes, or when it is shown on a screen with another pixel ratio.
+*/
+class DropIndicatorLabel : public QLabel
 {
-	QLabel* l = new QLabel();
-	l->setObjectName("DropAreaLabel");
+public:
+	DropIndicatorLabel(DropArea dropArea) :
+		QLabel(),
+		_dropArea(dropArea),
+		_devicePixelRatio(0)
+	{
+		setObjectName("DropAreaLabel");
+		updatePixmap();
+	}
+
+protected:
+	virtual bool event(QEvent* e)
+	{
+		switch (e->type())
+		{
+		case QEvent::PaletteChange:
+		case QEvent::FontChange:
+			_devicePixelRatio = 0;
+			updatePixmap();
+			break;
+		// The pixel ratio is compared on every paint, which covers moves to
+		// another screen. A new pixmap schedules one more paint.
+		case QEvent::Show:
+		case QEvent::Paint:
+			updatePixmap();
+			break;
+		default:
+			break;
+		}
+		return QLabel::event(e);
+	}
+
+private:
+	void updatePixmap()
+	{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 6, 0)
+		const qreal dpr = devicePixelRatioF();
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+		const qreal dpr = devicePixelRatio();
+#else
+		const qreal dpr = 1;
+#endif
+		if (dpr == _devicePixelRatio)
+			return;
+		_devicePixelRatio = dpr;
+
+		const qreal metric = static_cast<qreal>(fontMetrics().height()) * 2.f;
+		setPixmap(dropIndicatorPixmap(palette(), QSizeF(metric, metric), _dropArea, dpr));
+	}
+
+	DropArea _dropArea;
+	qreal _devicePixelRatio;
+};
 
-	const qreal metric = static_cast<qreal>(l->fontMetrics().height()) * 2.f;
-	const QSizeF size(metric, metric);
+static QWidget* createDropIndicatorWidget(DropArea dropArea)
+{
+	return new DropIndicatorLabel(dropArea);
+}
 
-	l->setPixmap(createDropIndicatorPixmap(l->palette(), size, dropArea));
-	return l;
+// Part of <em>r</em>, which is highlighted for the drop area.
+static QRect dropAreaRect(const QRect& r, DropArea dropArea)
+{
+	QRect ar = r;
+	switch (dropArea)
+	{
+	case ADS_NS::TopDropArea:
+		ar.setHeight(r.height() / 2);
+		break;
+	case ADS_NS::RightDropArea:
+		ar.setX(r.width() / 2);
+		break;
+	case ADS_NS::BottomDropArea:
+		ar.setY(r.height() / 2);
+		break;
+	case ADS_NS::LeftDropArea:
+		ar.setWidth(r.width() / 2);
+		break;
+	case ADS_NS::CenterDropArea:
+		break;
+	default:
+		ar = QRect();
+	}
+	return ar;
 }
 
 ///////////////////////////////////////////////////////////////////////
 
 DropOverlay::DropOverlay(QWidget* parent) :
 	QFrame(parent),
+	_mode(TopLevelMode),
 	_allowedAreas(InvalidDropArea),
 	_cross(new DropOverlayCross(this)),
 	_fullAreaDrop(false),
@@ -149,6 +259,34 @@ DropOverlay::~DropOverlay()
 {
 }
 
+void DropOverlay::setMode(Mode mode)
+{
+	if (mode == _mode)
+		return;
+
+	hideDropOverlay();
+	_mode = mode;
+
+	// Note: setWindowFlags() hides the widgets.
+	if (_mode == ChildMode)
+	{
+		setWindowFlags(Qt::Widget);
+		_cross->setWindowFlags(Qt::Widget);
+	}
+	else
+	{
+		setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
+		_cross->setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
+	}
+	setAttribute(Qt::WA_TransparentForMouseEvents, _mode == ChildMode);
+	_cross->setAttribute(Qt::WA_TransparentForMouseEvents, _mode == ChildMode);
+}
+
+DropOverlay::Mode DropOverlay::mode() const
+{
+	return _mode;
+}
+
 void DropOverlay::setAllowedAreas(DropAreas areas)
 {
 	if (areas == _allowedAreas)
@@ -170,36 +308,74 @@ void DropOverlay::setAreaWidgets(const QHash<DropArea, QWidget*>& widgets)
 
 DropArea DropOverlay::cursorLocation() const
 {
-	return _cross->cursorLocation();
+	return dropAreaAt(QCursor::pos());
+}
+
+/*
+	The cross is a top-level window at the position of the overlay, so the
+	global position is translated by its cached geometry, instead of asking
+	the window system with mapFromGlobal().
+*/
+DropArea DropOverlay::dropAreaAt(const QPoint& globalPos) const
+{
+	if (!_cross->isVisible())
+		return InvalidDropArea;
+	if (_mode == ChildMode)
+		return _cross->areaAt(globalPos - _parentGlobalPos - _cross->geometry().topLeft());
+	return _cross->areaAt(globalPos - _cross->geometry().topLeft());
 }
 
 DropArea DropOverlay::showDropOverlay(QWidget* target)
+{
+	return showDropOverlay(target, QCursor::pos());
+}
+
+DropArea DropOverlay::showDropOverlay(QWidget* target, const QPoint& globalPos)
 {
 	if (_target == target)
 	{
 		// Hint: We could update geometry of overlay here.
-		DropArea da = cursorLocation();
+		const DropArea da = dropAreaAt(globalPos);
 		if (da != _lastLocation)
 		{
-			repaint();
+			// Only the old and the new highlight need to be painted,
+			// including the outline drawn on their right and bottom edges.
+			QRegion region(dropAreaRect(rect(), _lastLocation).adjusted(0, 0, 1, 1));
+			region += dropAreaRect(rect(), da).adjusted(0, 0, 1, 1);
 			_lastLocation = da;
+			update(region);
 		}
 		return da;
 	}
 
-	hideDropOverlay();
+	const QRect geometry = targetGeometry(target, target->rect());
+	if (geometry.isNull())
+	{
+		hideDropOverlay();
+		return InvalidDropArea;
+	}
+
 	_fullAreaDrop = false;
 	_target = target;
 	_targetRect = QRect();
-	_lastLocation = InvalidDropArea;
 
-	// Move it over the target.
-	resize(target->size());
-	move(target->mapToGlobal(target->rect().topLeft()));
-
-	show();
+	// Move it over the target, the overlay (and cross) stays visible
+	// while the target changes.
+	setGeometry(geometry);
+	if (!isVisible())
+	{
+		show();
+	}
+	else if (_mode == TopLevelMode)
+	{
+		// The new target may be a floating window above the overlay.
+		raise();
+		_cross->raise();
+	}
+	update();
 
-	return cursorLocation();
+	_lastLocation = dropAreaAt(globalPos);
+	return _lastLocation;
 }
 
 void DropOverlay::showDropOverlay(QWidget* target, const QRect& targetAreaRect)
@@ -209,24 +385,29 @@ void DropOverlay::showDropOverlay(QWidget* target, const QRect& targetAreaRect)
 		return;
 	}
 
-	hideDropOverlay();
+	const QRect geometry = targetGeometry(target, targetAreaRect);
+	if (geometry.isNull())
+	{
+		hideDropOverlay();
+		return;
+	}
+
 	_fullAreaDrop = true;
 	_target = target;
 	_targetRect = targetAreaRect;
 	_lastLocation = InvalidDropArea;
 
 	// Move it over the target's area.
-	resize(targetAreaRect.size());
-	move(target->mapToGlobal(QPoint(targetAreaRect.x(), targetAreaRect.y())));
-
-	show();
-
-	return;
+	setGeometry(geometry);
+	if (!isVisible())
+		show();
+	update();
 }
 
 void DropOverlay::hideDropOverlay()
 {
-	hide();
+	if (isVisible())
+		hide();
 	_fullAreaDrop = false;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 	_target.clear();
@@ -242,6 +423,10 @@ void DropOverlay::paintEvent(QPaintEvent*)
 	QPainter p(this);
 	const QColor areaColor = palette().color(QPalette::Active, QPalette::Highlight);//QColor(0, 100, 255)
 
+	// Same look as the window opacity of the top-level overlay.
+	if (_mode == ChildMode)
+		p.setOpacity(0.2);
+
 	// Always draw drop-rect over the entire rect()
 	if (_fullAreaDrop)
 	{
@@ -253,28 +438,7 @@ void DropOverlay::paintEvent(QPaintEvent*)
 	}
 
 	// Draw rect based on location
-	QRect r = rect();
-	const DropArea da = cursorLocation();
-	switch (da)
-	{
-	case ADS_NS::TopDropArea:
-		r.setHeight(r.height() / 2);
-		break;
-	case ADS_NS::RightDropArea:
-		r.setX(r.width() / 2);
-		break;
-	case ADS_NS::BottomDropArea:
-		r.setY(r.height() / 2);
-		break;
-	case ADS_NS::LeftDropArea:
-		r.setWidth(r.width() / 2);
-		break;
-	case ADS_NS::CenterDropArea:
-		r = rect();
-		break;
-	default:
-		r = QRect();
-	}
+	const QRect r = dropAreaRect(rect(), _lastLocation);
 	if (!r.isNull())
 	{
 		p.fillRect(r, QBrush(areaColor, Qt::Dense4Pattern));
@@ -294,6 +458,15 @@ void DropOverlay::paintEvent(QPaintEvent*)
 
 void DropOverlay::showEvent(QShowEvent*)
 {
+	if (_mode == ChildMode)
+	{
+		// Children have no window opacity, paint above all siblings.
+		_parentGlobalPos = parentWidget()->mapToGlobal(QPoint(0, 0));
+		raise();
+		_cross->show();
+		_cross->raise();
+		return;
+	}
 	_cross->show();
 }
 
@@ -312,6 +485,22 @@ void DropOverlay::moveEvent(QMoveEvent* e)
 	_cross->move(e->pos());
 }
 
+// Returns the overlay geometry for <em>rect</em> of <em>target</em>,
+// in global or parent coordinates depending on the mode.
+QRect DropOverlay::targetGeometry(QWidget* target, const QRect& rect) const
+{
+	if (_mode == TopLevelMode)
+		return QRect(target->mapToGlobal(rect.topLeft()), rect.size());
+
+	QWidget* parent = parentWidget();
+	if (target != parent && !parent->isAncestorOf(target))
+	{
+		qWarning() << "DropOverlay: Target is not inside the parent of a child overlay" << target;
+		return QRect();
+	}
+	return QRect(target->mapTo(parent, rect.topLeft()), rect.size());
+}
+
 ///////////////////////////////////////////////////////////////////////
 
 static QPair<QPoint, int> gridPosForArea(const DropArea area)
@@ -336,7 +525,8 @@ static QPair<QPoint, int> gridPosForArea(const DropArea area)
 DropOverlayCross::DropOverlayCross(DropOverlay* overlay) :
 	QWidget(overlay->parentWidget()),
 	_overlay(overlay),
-	_widgets()
+	_widgets(),
+	_areaRectsDirty(true)
 {
 	setWindowFlags(Qt::Tool | Qt::FramelessWindowHint);
 	setWindowTitle("DropOverlayCross");
@@ -394,28 +584,58 @@ void DropOverlayCross::setAreaWidgets(const QHash<DropArea, QWidget*>& widgets)
 	reset();
 }
 
-DropArea DropOverlayCross::cursorLocation() const
+DropArea DropOverlayCross::areaAt(const QPoint& pos) const
 {
-	const QPoint pos = mapFromGlobal(QCursor::pos());
-	QHashIterator<DropArea, QWidget*> i(_widgets);
-	while (i.hasNext())
+	if (_areaRectsDirty)
+		updateAreaRects();
+
+	for (int i = 0; i < _areaRects.count(); ++i)
 	{
-		i.next();
-		if (_overlay->allowedAreas().testFlag(i.key())
-			&& i.value()
-			&& i.value()->isVisible()
-			&& i.value()->geometry().contains(pos))
-		{
-			return i.key();
-		}
+		if (_areaRects.at(i).contains(pos))
+			return _areas.at(i);
 	}
 	return InvalidDropArea;
 }
 
+bool DropOverlayCross::event(QEvent* e)
+{
+	// The grid positions the area widgets on a posted layout request.
+	if (e->type() == QEvent::LayoutRequest)
+		_areaRectsDirty = true;
+	return QWidget::event(e);
+}
+
 void DropOverlayCross::showEvent(QShowEvent*)
 {
 	resize(_overlay->size());
 	move(_overlay->pos());
+	_areaRectsDirty = true;
+}
+
+void DropOverlayCross::resizeEvent(QResizeEvent*)
+{
+	_areaRectsDirty = true;
+}
+
+void DropOverlayCross::updateAreaRects() const
+{
+	_areas.clear();
+	_areaRects.clear();
+
+	const DropAreas allowedAreas = _overlay->allowedAreas();
+	QHashIterator<DropArea, QWidget*> i(_widgets);
+	while (i.hasNext())
+	{
+		i.next();
+		if (allowedAreas.testFlag(i.key())
+			&& i.value()
+			&& !i.value()->isHidden())
+		{
+			_areas.append(i.key());
+			_areaRects.append(i.value()->geometry());
+		}
+	}
+	_areaRectsDirty = false;
 }
 
 void DropOverlayCross::reset()
@@ -423,6 +643,7 @@ void DropOverlayCross::reset()
 	QList<DropArea> allAreas;
 	allAreas << ADS_NS::TopDropArea << ADS_NS::RightDropArea << ADS_NS::BottomDropArea << ADS_NS::LeftDropArea << ADS_NS::CenterDropArea;
 	const DropAreas allowedAreas = _overlay->allowedAreas();
+	_areaRectsDirty = true;
 
 	// Update visibility of area widgets based on allowedAreas.
 	for (int i = 0; i < allAreas.count(); ++i)
@@ -7,18 +7,54 @@
 #include <QStyle>
 
 #include "ads/ContainerWidget.h"
+#include "ads/SectionWidget.h"
 #include "ads/SectionTitleWidget.h"
 #include "ads/SectionContentWidget.h"
 #include "ads/Internal.h"
 
 ADS_NAMESPACE_BEGIN
 
+FloatingWidget::FloatingWidget(ContainerWidget* container, QWidget* parent) :
+	QWidget(parent, Qt::CustomizeWindowHint | Qt::Tool),
+	_container(container),
+	_titleWidget(NULL),
+	_contentWidget(NULL),
+	_section(NULL)
+{
+	createFrame();
+}
+
 FloatingWidget::FloatingWidget(ContainerWidget* container, SectionContent::RefPtr sc, SectionTitleWidget* titleWidget, SectionContentWidget* contentWidget, QWidget* parent) :
 	QWidget(parent, Qt::CustomizeWindowHint | Qt::Tool),
 	_container(container),
-	_content(sc),
-	_titleWidget(titleWidget),
-	_contentWidget(contentWidget)
+	_titleWidget(NULL),
+	_contentWidget(NULL),
+	_section(NULL)
+{
+	createFrame();
+	setContent(sc, titleWidget, contentWidget);
+}
+
+FloatingWidget::~FloatingWidget()
+{
+	_section = NULL; // Deleted as child, which must not delete this window again.
+	_container->_floatings.removeAll(this); // Note: I don't like this here, but we have to remove it from list...
+	if (_content && SCLocationMapById(_container).value(_content->uid()).floating == this)
+		SCLocationMapById(_container).remove(_content->uid());
+}
+
+QList<SectionContent::RefPtr> FloatingWidget::contents() const
+{
+	if (_section)
+		return _section->contents();
+
+	QList<SectionContent::RefPtr> contents;
+	if (_content)
+		contents.append(_content);
+	return contents;
+}
+
+void FloatingWidget::createFrame()
 {
 	QBoxLayout* l = new QBoxLayout(QBoxLayout::TopToBottom);
 	l->setContentsMargins(0, 0, 0, 0);
@@ -27,36 +63,46 @@ FloatingWidget::FloatingWidget(ContainerWidget* container, SectionContent::RefPt
 
 	// Title + Controls
 	_titleLayout = new QBoxLayout(QBoxLayout::LeftToRight);
-	_titleLayout->addWidget(titleWidget, 1);
 	l->addLayout(_titleLayout, 0);
-	titleWidget->setActiveTab(false);
 
-	if (sc->flags().testFlag(SectionContent::Closeable))
-	{
-		QPushButton* closeButton = new QPushButton();
-		closeButton->setObjectName("closeButton");
-		closeButton->setFlat(true);
-		closeButton->setIcon(style()->standardIcon(QStyle::SP_TitleBarCloseButton));
-		closeButton->setToolTip(tr("Close"));
-		closeButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-		_titleLayout->addWidget(closeButton);
+	_closeButton = new QPushButton();
+	_closeButton->setObjectName("closeButton");
+	_closeButton->setFlat(true);
+	_closeButton->setIcon(style()->standardIcon(QStyle::SP_TitleBarCloseButton));
+	_closeButton->setToolTip(tr("Close"));
+	_closeButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+	_closeButton->setVisible(false);
+	_titleLayout->addWidget(_closeButton);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-		QObject::connect(closeButton, &QPushButton::clicked, this, &FloatingWidget::onCloseButtonClicked);
+	QObject::connect(_closeButton, &QPushButton::clicked, this, &FloatingWidget::onCloseButtonClicked);
 #else
-		QObject::connect(closeButton, SIGNAL(clicked(bool)), this, SLOT(onCloseButtonClicked()));
+	QObject::connect(_closeButton, SIGNAL(clicked(bool)), this, SLOT(onCloseButtonClicked()));
 #endif
-	}
+}
+
+void FloatingWidget::setContent(SectionContent::RefPtr sc, SectionTitleWidget* titleWidget, SectionContentWidget* contentWidget)
+{
+	ADS_Expects(_titleWidget == NULL && _contentWidget == NULL);
+
+	_content = sc;
+	_titleWidget = titleWidget;
+	_contentWidget = contentWidget;
+
+	// Title + Controls
+	_titleLayout->insertWidget(0, titleWidget, 1);
+	titleWidget->setActiveTab(false);
+	titleWidget->_fw = this;
+	_closeButton->setVisible(sc->flags().testFlag(SectionContent::Closeable));
 
 	// Content
-	l->addWidget(contentWidget, 1);
+	static_cast<QBoxLayout*>(layout())->addWidget(contentWidget, 1);
 	contentWidget->show();
 
-//	_container->_floatingWidgets.append(this);
-}
-
-FloatingWidget::~FloatingWidget()
-{
-	_container->_floatings.removeAll(this); // Note: I don't like this here, but we have to remove it from list...
+	ContentLocation& loc = SCLocationMapById(_container)[sc->uid()];
+	loc.type = ContentLocation::FloatingLocation;
+	loc.section = NULL;
+	loc.floating = this;
+	loc.index = -1;
 }
 
 bool FloatingWidget::takeContent(InternalContentData& data)
@@ -67,12 +113,46 @@ bool FloatingWidget::takeContent(InternalContentData& data)
 
 	_titleLayout->removeWidget(_titleWidget);
 	_titleWidget->setParent(_container);
+	if (_titleWidget->_fw == this)
+		_titleWidget->_fw = NULL;
 	_titleWidget = NULL;
 
 	layout()->removeWidget(_contentWidget);
 	_contentWidget->setParent(_container);
 	_contentWidget = NULL;
 
+	if (SCLocationMapById(_container).value(_content->uid()).floating == this)
+		SCLocationMapById(_container).remove(_content->uid());
+
+	return true;
+}
+
+// Adds "data" as a tab. The first call turns the window into a tabbed window,
+// which moves the own content into a SectionWidget and gets a native title bar.
+bool FloatingWidget::addContent(const InternalContentData& data)
+{
+	if (!_section)
+	{
+		InternalContentData own;
+		if (_titleWidget && !takeContent(own))
+			return false;
+		_content.clear();
+		_closeButton->setVisible(false);
+
+		_section = new SectionWidget(_container);
+		static_cast<QBoxLayout*>(layout())->addWidget(_section, 1);
+
+		// Note: setWindowFlags() hides the window.
+		const bool visible = isVisible();
+		const QRect geometry = this->geometry();
+		setWindowFlags(Qt::Tool);
+		setGeometry(geometry);
+		setVisible(visible);
+
+		if (own.content)
+			_section->addContent(own, false);
+	}
+	_section->addContent(data, true);
 	return true;
 }
 
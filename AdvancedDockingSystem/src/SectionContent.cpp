@@ -2,6 +2,8 @@
 
 #include <QWidget>
 #include <QLabel>
+#include <QLayout>
+#include <QDebug>
 
 #include "ads/Internal.h"
 #include "ads/ContainerWidget.h"
@@ -10,11 +12,32 @@ ADS_NAMESPACE_BEGIN
 
 SectionContent::SectionContent() :
 	_uid(GetNextUid()),
+	_hibernated(false),
 	_flags(AllFlags)
 {
 }
 
 SectionContent::RefPtr SectionContent::newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, QWidget* content)
+{
+	if (!content)
+	{
+		qFatal("Can not create SectionContent with NULL values");
+		return RefPtr();
+	}
+	return newSectionContent(uniqueName, container, title, content, QSharedPointer<SectionContentFactory>());
+}
+
+SectionContent::RefPtr SectionContent::newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, const QSharedPointer<SectionContentFactory>& factory)
+{
+	if (!factory)
+	{
+		qFatal("Can not create SectionContent with NULL values");
+		return RefPtr();
+	}
+	return newSectionContent(uniqueName, container, title, NULL, factory);
+}
+
+SectionContent::RefPtr SectionContent::newSectionContent(const QString& uniqueName, ContainerWidget* container, QWidget* title, QWidget* content, const QSharedPointer<SectionContentFactory>& factory)
 {
 	if (uniqueName.isEmpty())
 	{
@@ -26,7 +49,7 @@ SectionContent::RefPtr SectionContent::newSectionContent(const QString& uniqueNa
 		qFatal("Can not create SectionContent with already used uniqueName");
 		return RefPtr();
 	}
-	else if (!container || !title || !content)
+	else if (!container || !title)
 	{
 		qFatal("Can not create SectionContent with NULL values");
 		return RefPtr();
@@ -37,6 +60,7 @@ SectionContent::RefPtr SectionContent::newSectionContent(const QString& uniqueNa
 	sc->_containerWidget = container;
 	sc->_titleWidget = title;
 	sc->_contentWidget = content;
+	sc->_contentFactory = factory;
 
 	SCLookupMapById(container).insert(sc->uid(), sc);
 	SCLookupMapByName(container).insert(sc->uniqueName(), sc);
@@ -76,9 +100,39 @@ QWidget* SectionContent::titleWidget() const
 
 QWidget* SectionContent::contentWidget() const
 {
+	if (!_contentWidget && _contentFactory)
+		const_cast<SectionContent*>(this)->loadContentWidget();
 	return _contentWidget;
 }
 
+bool SectionContent::isContentWidgetLoaded() const
+{
+	return !_contentWidget.isNull();
+}
+
+void SectionContent::loadContentWidget()
+{
+	_contentWidget = _contentFactory->createContentWidget(_uniqueName);
+	if (!_contentWidget)
+	{
+		qWarning() << "Factory did not create a content widget for" << _uniqueName;
+		return;
+	}
+	if (_hibernated)
+	{
+		_contentFactory->restoreContentState(_uniqueName, _contentWidget, _hibernatedState);
+		_hibernatedState.clear();
+		_hibernated = false;
+	}
+
+	// Replaces the placeholder, if the content is already part of the UI.
+	if (_contentWrapper && _contentWrapper->layout())
+		_contentWrapper->layout()->addWidget(_contentWidget);
+
+	if (_containerWidget)
+		_containerWidget->touchHibernation(_uid, _contentWrapper && _contentWrapper->isVisible());
+}
+
 SectionContent::Flags SectionContent::flags() const
 {
 	return _flags;
@@ -1,6 +1,10 @@
 #include "ads/SectionContentWidget.h"
 
 #include <QBoxLayout>
+#include <QShowEvent>
+#include <QHideEvent>
+
+#include "ads/ContainerWidget.h"
 
 ADS_NAMESPACE_BEGIN
 
@@ -11,13 +15,33 @@ SectionContentWidget::SectionContentWidget(SectionContent::RefPtr c, QWidget* pa
 	QBoxLayout* l = new QBoxLayout(QBoxLayout::TopToBottom);
 	l->setContentsMargins(0, 0, 0, 0);
 	l->setSpacing(0);
-	l->addWidget(_content->contentWidget());
 	setLayout(l);
+
+	// Contents with a factory stay an empty placeholder until they get shown.
+	_content->_contentWrapper = this;
+	if (_content->isContentWidgetLoaded())
+		l->addWidget(_content->_contentWidget);
 }
 
 SectionContentWidget::~SectionContentWidget()
 {
-	layout()->removeWidget(_content->contentWidget());
+	if (_content->_contentWidget)
+		layout()->removeWidget(_content->_contentWidget);
+}
+
+void SectionContentWidget::showEvent(QShowEvent* e)
+{
+	if (!_content->isContentWidgetLoaded())
+		_content->contentWidget();
+	else if (!e->spontaneous() && _content->containerWidget())
+		_content->containerWidget()->touchHibernation(_content->uid(), true);
+}
+
+void SectionContentWidget::hideEvent(QHideEvent* e)
+{
+	// Spontaneous events (e.g. minimized window) don't make a content inactive.
+	if (!e->spontaneous() && _content->containerWidget())
+		_content->containerWidget()->touchHibernation(_content->uid(), false);
 }
 
 ADS_NAMESPACE_END
@@ -4,11 +4,12 @@
 #include <QApplication>
 #include <QBoxLayout>
 #include <QMouseEvent>
+#include <QKeyEvent>
 #include <QMimeData>
 #include <QDrag>
-#include <QCursor>
 #include <QStyle>
 #include <QSplitter>
+#include <QLabel>
 
 #ifdef ADS_ANIMATIONS_ENABLED
 #include <QPropertyAnimation>
@@ -24,10 +25,32 @@
 
 ADS_NAMESPACE_BEGIN
 
+// Static Helper //////////////////////////////////////////////////////
+
+// Snapshot of <em>section</em>, which follows the mouse during an outline drag.
+static QWidget* createDragPreview(SectionWidget* section, QWidget* parent)
+{
+	QLabel* l = new QLabel(parent, Qt::Tool | Qt::FramelessWindowHint);
+	l->setObjectName("DragPreview");
+	l->setAttribute(Qt::WA_TransparentForMouseEvents);
+	l->setWindowOpacity(0.6);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	l->setPixmap(section->grab());
+#else
+	l->setPixmap(QPixmap::grabWidget(section));
+#endif
+	l->resize(section->size());
+	return l;
+}
+
+///////////////////////////////////////////////////////////////////////
+
 SectionTitleWidget::SectionTitleWidget(SectionContent::RefPtr content, QWidget* parent) :
 	QFrame(parent),
 	_content(content),
+	_originIndex(-1),
 	_tabMoving(false),
+	_tabTargetIndex(-1),
 	_activeTab(false)
 {
 	QBoxLayout* l = new QBoxLayout(QBoxLayout::LeftToRight);
@@ -35,10 +58,14 @@ SectionTitleWidget::SectionTitleWidget(SectionContent::RefPtr content, QWidget*
 	l->setSpacing(0);
 	l->addWidget(content->titleWidget());
 	setLayout(l);
+
+	if (usesActiveTabPalettes())
+		updateActiveTabStyle();
 }
 
 SectionTitleWidget::~SectionTitleWidget()
 {
+	delete _dragPreview;
 	layout()->removeWidget(_content->titleWidget());
 }
 
@@ -52,13 +79,40 @@ void SectionTitleWidget::setActiveTab(bool active)
 	if (active != _activeTab)
 	{
 		_activeTab = active;
+		updateActiveTabStyle();
+		emit activeTabChanged();
+	}
+}
 
+// The palettes of the ContainerWidget are ignored while a style sheet applies,
+// it would paint over them and its "activeTab" rules would never be re-evaluated.
+bool SectionTitleWidget::usesActiveTabPalettes() const
+{
+	ContainerWidget* cw = _content->containerWidget();
+	return cw && cw->hasActiveTabPalettes() && !style()->inherits("QStyleSheetStyle");
+}
+
+// Applies the "activeTab" state to the look of the widget. Without palettes
+// of the ContainerWidget, the style (sheet) is re-evaluated by a repolish.
+void SectionTitleWidget::updateActiveTabStyle()
+{
+	ContainerWidget* cw = _content->containerWidget();
+	if (usesActiveTabPalettes())
+	{
+		setAutoFillBackground(true);
+		setPalette(_activeTab ? cw->_activeTabPalette : cw->_inactiveTabPalette);
+	}
+	else
+	{
+		if (autoFillBackground())
+		{
+			setAutoFillBackground(false);
+			setPalette(QPalette());
+		}
 		style()->unpolish(this);
 		style()->polish(this);
-		update();
-
-		emit activeTabChanged();
 	}
+	update();
 }
 
 void SectionTitleWidget::mousePressEvent(QMouseEvent* ev)
@@ -67,6 +121,14 @@ void SectionTitleWidget::mousePressEvent(QMouseEvent* ev)
 	{
 		ev->accept();
 		_dragStartPos = ev->pos();
+
+		// Mouse moves translate global positions with this offset,
+		// instead of a mapFromGlobal() call for each of them.
+		ContainerWidget* cw = findParentContainerWidget(this);
+		if (cw)
+			_containerGlobalPos = cw->mapToGlobal(QPoint(0, 0));
+		if (_fw)
+			_fwStartPos = _fw->pos();
 		return;
 	}
 	QFrame::mousePressEvent(ev);
@@ -77,25 +139,42 @@ void SectionTitleWidget::mouseReleaseEvent(QMouseEvent* ev)
 	SectionWidget* section = NULL;
 	ContainerWidget* cw = findParentContainerWidget(this);
 
-	// Drop contents of FloatingWidget into SectionWidget.
-	if (_fw)
+	// Drop contents of FloatingWidget into the tab strip of a section.
+	if (_fw && _tabTarget)
+	{
+		dropToTabTarget(NULL);
+	}
+	// Drop contents of FloatingWidget into SectionWidget, unless the move got cancelled.
+	else if (_fw && !_dragStartPos.isNull())
 	{
-		SectionWidget* sw = cw->sectionAt(cw->mapFromGlobal(ev->globalPos()));
-		if (sw)
+		const QPoint pos = ev->globalPos() - _containerGlobalPos;
+		FloatingWidget* target = cw->floatingDropTargetAt(ev->globalPos(), _fw);
+		SectionWidget* sw = target ? NULL : cw->sectionAt(pos);
+
+		// Mouse is over another floating window, add the contents as tab.
+		if (target)
+		{
+			cw->_dropOverlay->setAllowedAreas(ADS_NS::CenterDropArea);
+			if (cw->_dropOverlay->showDropOverlay(target, ev->globalPos()) == ADS_NS::CenterDropArea)
+			{
+				InternalContentData data;
+				FloatingWidget* fw = _fw;
+				fw->takeContent(data); // Resets _fw
+				cw->recycleFloatingWidget(fw);
+				target->addContent(data);
+			}
+		}
+		else if (sw)
 		{
 			cw->_dropOverlay->setAllowedAreas(ADS_NS::AllAreas);
-			DropArea loc = cw->_dropOverlay->showDropOverlay(sw);
+			DropArea loc = cw->_dropOverlay->showDropOverlay(sw, ev->globalPos());
 			if (loc != InvalidDropArea)
 			{
 #if !defined(ADS_ANIMATIONS_ENABLED)
 				InternalContentData data;
-				_fw->takeContent(data);
-				_fw->deleteLater();
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-				_fw.clear();
-#else
-				_fw = 0;
-#endif
+				FloatingWidget* fw = _fw;
+				fw->takeContent(data); // Resets _fw
+				cw->recycleFloatingWidget(fw);
 				cw->dropContent(data, sw, loc, true);
 #else
 				QPropertyAnimation* moveAnim = new QPropertyAnimation(_fw, "pos", this);
@@ -126,32 +205,40 @@ void SectionTitleWidget::mouseReleaseEvent(QMouseEvent* ev)
 		else
 		{
 			DropArea dropArea = ADS_NS::InvalidDropArea;
-			if (cw->outerTopDropRect().contains(cw->mapFromGlobal(ev->globalPos())))
+			if (cw->outerTopDropRect().contains(pos))
 				dropArea = ADS_NS::TopDropArea;
-			if (cw->outerRightDropRect().contains(cw->mapFromGlobal(ev->globalPos())))
+			if (cw->outerRightDropRect().contains(pos))
 				dropArea = ADS_NS::RightDropArea;
-			if (cw->outerBottomDropRect().contains(cw->mapFromGlobal(ev->globalPos())))
+			if (cw->outerBottomDropRect().contains(pos))
 				dropArea = ADS_NS::BottomDropArea;
-			if (cw->outerLeftDropRect().contains(cw->mapFromGlobal(ev->globalPos())))
+			if (cw->outerLeftDropRect().contains(pos))
 				dropArea = ADS_NS::LeftDropArea;
 
 			if (dropArea != ADS_NS::InvalidDropArea)
 			{
 #if !defined(ADS_ANIMATIONS_ENABLED)
 				InternalContentData data;
-				_fw->takeContent(data);
-				_fw->deleteLater();
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-				_fw.clear();
-#else
-				_fw = 0;
-#endif
+				FloatingWidget* fw = _fw;
+				fw->takeContent(data); // Resets _fw
+				cw->recycleFloatingWidget(fw);
 				cw->dropContent(data, NULL, dropArea, true);
 #else
 #endif
 			}
 		}
 	}
+	// Move the content into the tab strip of another section.
+	else if (_tabTarget
+			&& (section = findParentSectionWidget(this)) != NULL)
+	{
+		dropToTabTarget(section);
+	}
+	// Move the content of an outline drag, it stayed in its section until now.
+	else if (_dragPreview)
+	{
+		delete _dragPreview;
+		dropOutlineDrag(cw, ev->globalPos());
+	}
 	// End of tab moving, change order now
 	else if (_tabMoving
 			&& (section = findParentSectionWidget(this)) != NULL)
@@ -160,16 +247,23 @@ void SectionTitleWidget::mouseReleaseEvent(QMouseEvent* ev)
 		QPoint pos = ev->globalPos();
 		pos = section->mapFromGlobal(pos);
 		const int fromIndex = section->indexOfContent(_content);
-		const int toIndex = section->indexOfContentByTitlePos(pos, this);
+		const int toIndex = section->indexOfContentByTitlePos(pos);
+		section->hideTabInsertMarker();
 		section->moveContent(fromIndex, toIndex);
 	}
 
 	if (!_dragStartPos.isNull())
 		emit clicked();
 
+	// The origin section goes away now, if the drop didn't fill it again.
+	releaseOrigin();
+
 	// Reset
 	_dragStartPos = QPoint();
 	_tabMoving = false;
+	setTabTarget(NULL, -1);
+	if (keyboardGrabber() == this)
+		releaseKeyboard();
 	cw->_dropOverlay->hideDropOverlay();
 	QFrame::mouseReleaseEvent(ev);
 }
@@ -178,62 +272,82 @@ void SectionTitleWidget::mouseMoveEvent(QMouseEvent* ev)
 {
 	ContainerWidget* cw = findParentContainerWidget(this);
 	SectionWidget* section = NULL;
+	SectionWidget* target = NULL;
 
 	// Move already existing FloatingWidget
-	if (_fw && (ev->buttons() & Qt::LeftButton))
+	if (_fw && !_dragStartPos.isNull() && (ev->buttons() & Qt::LeftButton))
 	{
 		ev->accept();
+		if (keyboardGrabber() != this)
+			grabKeyboard(); // Escape cancels the move
 
 		const QPoint moveToPos = ev->globalPos() - (_dragStartPos + QPoint(ADS_WINDOW_FRAME_BORDER_WIDTH, ADS_WINDOW_FRAME_BORDER_WIDTH));
 		_fw->move(moveToPos);
 
-		// Show drop indicator
-		if (true)
+		// Show tab insert marker or drop indicator
+		if ((target = tabStripTargetAt(cw, ev->globalPos(), _originSection)) != NULL)
 		{
-			// Mouse is over a SectionWidget
-			section = cw->sectionAt(cw->mapFromGlobal(QCursor::pos()));
-			if (section)
-			{
-				cw->_dropOverlay->setAllowedAreas(ADS_NS::AllAreas);
-				cw->_dropOverlay->showDropOverlay(section);
-			}
-			// Mouse is at the edge of the ContainerWidget
-			// Top, Right, Bottom, Left
-			else if (cw->outerTopDropRect().contains(cw->mapFromGlobal(QCursor::pos())))
-			{
-				cw->_dropOverlay->setAllowedAreas(ADS_NS::TopDropArea);
-				cw->_dropOverlay->showDropOverlay(cw, cw->outerTopDropRect());
-			}
-			else if (cw->outerRightDropRect().contains(cw->mapFromGlobal(QCursor::pos())))
-			{
-				cw->_dropOverlay->setAllowedAreas(ADS_NS::RightDropArea);
-				cw->_dropOverlay->showDropOverlay(cw, cw->outerRightDropRect());
-			}
-			else if (cw->outerBottomDropRect().contains(cw->mapFromGlobal(QCursor::pos())))
-			{
-				cw->_dropOverlay->setAllowedAreas(ADS_NS::BottomDropArea);
-				cw->_dropOverlay->showDropOverlay(cw, cw->outerBottomDropRect());
-			}
-			else if (cw->outerLeftDropRect().contains(cw->mapFromGlobal(QCursor::pos())))
-			{
-				cw->_dropOverlay->setAllowedAreas(ADS_NS::LeftDropArea);
-				cw->_dropOverlay->showDropOverlay(cw, cw->outerLeftDropRect());
-			}
-			else
-			{
-				cw->_dropOverlay->hideDropOverlay();
-			}
+			cw->_dropOverlay->hideDropOverlay();
+			setTabTarget(target, target->tabInsertIndexAt(target->mapFromGlobal(ev->globalPos())));
+		}
+		else
+		{
+			setTabTarget(NULL, -1);
+			showDropIndicator(cw, ev->globalPos());
 		}
 		return;
 	}
+	// Move the snapshot of an outline drag
+	else if (_dragPreview && (ev->buttons() & Qt::LeftButton))
+	{
+		ev->accept();
+		_dragPreview->move(ev->globalPos() - _dragPreviewOffset);
+		if ((target = tabStripTargetAt(cw, ev->globalPos(), findParentSectionWidget(this))) != NULL)
+		{
+			cw->_dropOverlay->hideDropOverlay();
+			setTabTarget(target, target->tabInsertIndexAt(target->mapFromGlobal(ev->globalPos())));
+		}
+		else
+		{
+			setTabTarget(NULL, -1);
+			showDropIndicator(cw, ev->globalPos());
+		}
+		return;
+	}
+	// Drag the tab over the tab strip of another section, nothing floats. Close to
+	// any title area the drag stays pending, e.g. while crossing a splitter handle.
+	else if (!_fw && !_dragPreview && !_dragStartPos.isNull() && (ev->buttons() & Qt::LeftButton)
+			&& (section = findParentSectionWidget(this)) != NULL
+			&& !section->titleAreaGeometry().contains(section->mapFromGlobal(ev->globalPos()))
+			&& ((target = tabStripTargetAt(cw, ev->globalPos(), section)) != NULL || isNearTitleArea(cw, ev->globalPos())))
+	{
+		ev->accept();
+		section->hideTabInsertMarker();
+		cw->_dropOverlay->hideDropOverlay();
+		setTabTarget(target, target ? target->tabInsertIndexAt(target->mapFromGlobal(ev->globalPos())) : -1);
+		return;
+	}
 	// Begin to drag/float the SectionContent.
-	else if (!_fw && !_dragStartPos.isNull() && (ev->buttons() & Qt::LeftButton)
+	else if (!_fw && !_dragPreview && !_dragStartPos.isNull() && (ev->buttons() & Qt::LeftButton)
 			&& (section = findParentSectionWidget(this)) != NULL
 			&& !section->titleAreaGeometry().contains(section->mapFromGlobal(ev->globalPos())))
 	{
 		ev->accept();
+		setTabTarget(NULL, -1);
+
+		// Outline drag, the content stays in place until the drop.
+		if (cw->isOutlineDragEnabled())
+		{
+			_dragPreview = createDragPreview(section, cw);
+			_dragPreviewOffset = mapTo(section, _dragStartPos);
+			_dragPreview->move(ev->globalPos() - _dragPreviewOffset);
+			_dragPreview->show();
+			grabKeyboard(); // Escape cancels the drag
+			return;
+		}
 
 		// Create floating widget.
+		const int index = section->indexOfContent(_content);
 		InternalContentData data;
 		if (!section->takeContent(_content->uid(), data))
 		{
@@ -241,21 +355,21 @@ void SectionTitleWidget::mouseMoveEvent(QMouseEvent* ev)
 			return;
 		}
 
-		_fw = new FloatingWidget(cw, data.content, data.titleWidget, data.contentWidget, cw);
+		_fw = cw->newFloatingWidget(data);
 		_fw->resize(section->size());
 		cw->_floatings.append(_fw); // Note: I don't like this...
 
 		const QPoint moveToPos = ev->globalPos() - (_dragStartPos + QPoint(ADS_WINDOW_FRAME_BORDER_WIDTH, ADS_WINDOW_FRAME_BORDER_WIDTH));
 		_fw->move(moveToPos);
 		_fw->show();
+		grabKeyboard(); // Escape cancels the drag
 
-		// Delete old section, if it is empty now.
+		// The old section keeps its place until the drop, which avoids a relayout
+		// of the container in the middle of the drag. An empty one shows a ghost tab.
+		_originSection = section;
+		_originIndex = index;
 		if (section->contents().isEmpty())
-		{
-			delete section;
-			section = NULL;
-		}
-		deleteEmptySplitter(cw);
+			section->showGhostTab(_content->visibleTitle());
 		return;
 	}
 	// Handle movement of this tab
@@ -263,6 +377,7 @@ void SectionTitleWidget::mouseMoveEvent(QMouseEvent* ev)
 			&& (section = findParentSectionWidget(this)) != NULL)
 	{
 		ev->accept();
+		setTabTarget(NULL, -1);
 
 		int left, top, right, bottom;
 		getContentsMargins(&left, &top, &right, &bottom);
@@ -270,6 +385,10 @@ void SectionTitleWidget::mouseMoveEvent(QMouseEvent* ev)
 		moveToPos.setY(0/* + top*/);
 		move(moveToPos);
 
+		// Live insertion slot
+		const QPoint pos = section->mapFromGlobal(ev->globalPos());
+		section->showTabInsertMarker(section->indexOfContent(_content), section->indexOfContentByTitlePos(pos));
+
 		return;
 	}
 	// Begin to drag title inside the title area to switch its position inside the SectionWidget.
@@ -288,4 +407,313 @@ void SectionTitleWidget::mouseMoveEvent(QMouseEvent* ev)
 	QFrame::mouseMoveEvent(ev);
 }
 
+void SectionTitleWidget::showDropIndicator(ContainerWidget* cw, const QPoint& globalPos)
+{
+	// Mouse is over a floating window, which can only take tabs
+	const QPoint pos = globalPos - _containerGlobalPos;
+	FloatingWidget* floating = cw->floatingDropTargetAt(globalPos, _fw);
+	if (floating)
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::CenterDropArea);
+		cw->_dropOverlay->showDropOverlay(floating, globalPos);
+		return;
+	}
+
+	// Mouse is over a SectionWidget
+	SectionWidget* section = cw->sectionAt(pos);
+	if (section)
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::AllAreas);
+		cw->_dropOverlay->showDropOverlay(section, globalPos);
+	}
+	// Mouse is at the edge of the ContainerWidget
+	// Top, Right, Bottom, Left
+	else if (cw->outerTopDropRect().contains(pos))
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::TopDropArea);
+		cw->_dropOverlay->showDropOverlay(cw, cw->outerTopDropRect());
+	}
+	else if (cw->outerRightDropRect().contains(pos))
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::RightDropArea);
+		cw->_dropOverlay->showDropOverlay(cw, cw->outerRightDropRect());
+	}
+	else if (cw->outerBottomDropRect().contains(pos))
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::BottomDropArea);
+		cw->_dropOverlay->showDropOverlay(cw, cw->outerBottomDropRect());
+	}
+	else if (cw->outerLeftDropRect().contains(pos))
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::LeftDropArea);
+		cw->_dropOverlay->showDropOverlay(cw, cw->outerLeftDropRect());
+	}
+	else
+	{
+		cw->_dropOverlay->hideDropOverlay();
+	}
+}
+
+// Returns the drop area at <em>globalPos</em> and its section or floating window,
+// both are NULL for the outer drop areas.
+DropArea SectionTitleWidget::dropTargetAt(ContainerWidget* cw, const QPoint& globalPos, SectionWidget*& section, FloatingWidget*& floating)
+{
+	section = NULL;
+	floating = cw->floatingDropTargetAt(globalPos, NULL);
+	if (floating)
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::CenterDropArea);
+		return cw->_dropOverlay->showDropOverlay(floating, globalPos);
+	}
+
+	const QPoint pos = globalPos - _containerGlobalPos;
+	section = cw->sectionAt(pos);
+	if (section)
+	{
+		cw->_dropOverlay->setAllowedAreas(ADS_NS::AllAreas);
+		return cw->_dropOverlay->showDropOverlay(section, globalPos);
+	}
+	else if (cw->outerTopDropRect().contains(pos))
+		return ADS_NS::TopDropArea;
+	else if (cw->outerRightDropRect().contains(pos))
+		return ADS_NS::RightDropArea;
+	else if (cw->outerBottomDropRect().contains(pos))
+		return ADS_NS::BottomDropArea;
+	else if (cw->outerLeftDropRect().contains(pos))
+		return ADS_NS::LeftDropArea;
+	return ADS_NS::InvalidDropArea;
+}
+
+// Moves the content to the drop target at <em>globalPos</em>, or into a new
+// FloatingWidget at that position, if there is no drop target.
+void SectionTitleWidget::dropOutlineDrag(ContainerWidget* cw, const QPoint& globalPos)
+{
+	SectionWidget* source = findParentSectionWidget(this);
+	if (!source)
+		return;
+
+	SectionWidget* target = NULL;
+	FloatingWidget* floating = NULL;
+	const DropArea area = dropTargetAt(cw, globalPos, target, floating);
+
+	// Dropping a content into its own section changes nothing.
+	if (area != ADS_NS::InvalidDropArea && target == source
+			&& (area == ADS_NS::CenterDropArea || source->contents().count() == 1))
+		return;
+	if (area != ADS_NS::InvalidDropArea && floating && floating->section() == source)
+		return;
+
+	const QSize size = source->size();
+	InternalContentData data;
+	if (!source->takeContent(_content->uid(), data))
+	{
+		qWarning() << "THIS SHOULD NOT HAPPEN!!" << _content->uid() << _content->uniqueName();
+		return;
+	}
+
+	if (area != ADS_NS::InvalidDropArea && floating)
+	{
+		floating->addContent(data);
+	}
+	else if (area != ADS_NS::InvalidDropArea)
+	{
+		cw->dropContent(data, target, area, true);
+	}
+	else
+	{
+		_fw = cw->newFloatingWidget(data);
+		_fw->resize(size);
+		cw->_floatings.append(_fw);
+		_fw->move(globalPos - (_dragStartPos + QPoint(ADS_WINDOW_FRAME_BORDER_WIDTH, ADS_WINDOW_FRAME_BORDER_WIDTH)));
+		_fw->show();
+	}
+
+	// Delete old section, if it is empty now.
+	// Its widgets have been moved to the drop target already.
+	if (source->contents().isEmpty())
+	{
+		QSplitter* splitter = qobject_cast<QSplitter*>(source->parentWidget());
+		delete source;
+		deleteEmptySplitter(splitter);
+	}
+}
+
+void SectionTitleWidget::keyPressEvent(QKeyEvent* ev)
+{
+	if (ev->key() == Qt::Key_Escape && !_dragStartPos.isNull())
+	{
+		ev->accept();
+		cancelDrag();
+		return;
+	}
+	QFrame::keyPressEvent(ev);
+}
+
+void SectionTitleWidget::changeEvent(QEvent* e)
+{
+	// A style sheet got set or removed, switch between palettes and repolish.
+	if (e->type() == QEvent::StyleChange)
+	{
+		ContainerWidget* cw = _content->containerWidget();
+		if (cw && cw->hasActiveTabPalettes() && autoFillBackground() != usesActiveTabPalettes())
+			updateActiveTabStyle();
+	}
+	QFrame::changeEvent(e);
+}
+
+// Deletes the origin section of a tear-off, if it is still empty after the drop.
+void SectionTitleWidget::releaseOrigin()
+{
+	SectionWidget* section = _originSection;
+	_originSection.clear();
+	_originIndex = -1;
+	if (!section)
+		return;
+
+	section->hideGhostTab();
+	if (section->contents().isEmpty())
+	{
+		QSplitter* splitter = qobject_cast<QSplitter*>(section->parentWidget());
+		delete section;
+		deleteEmptySplitter(splitter);
+	}
+}
+
+// Restores the state before the drag. A torn off content goes back to its slot
+// in the origin section, which never left its place.
+void SectionTitleWidget::cancelDrag()
+{
+	ContainerWidget* cw = findParentContainerWidget(this);
+	SectionWidget* origin = _originSection;
+	if (origin && _fw)
+	{
+		InternalContentData data;
+		FloatingWidget* fw = _fw;
+		fw->takeContent(data); // Resets _fw
+		cw->recycleFloatingWidget(fw);
+
+		origin->hideGhostTab();
+		origin->addContent(data, true);
+		const int last = origin->contents().count() - 1;
+		if (_originIndex >= 0 && _originIndex < last)
+			origin->moveContent(last, _originIndex);
+	}
+	// An existing floating window goes back to its position.
+	else if (_fw && !_dragStartPos.isNull())
+	{
+		_fw->move(_fwStartPos);
+	}
+	_originSection.clear();
+	_originIndex = -1;
+
+	delete _dragPreview;
+	setTabTarget(NULL, -1);
+
+	// A tab moved within its strip goes back to its slot.
+	SectionWidget* section = findParentSectionWidget(this);
+	if (section && _tabMoving)
+	{
+		_tabMoving = false;
+		section->hideTabInsertMarker();
+		if (section->_tabStrip)
+			section->_tabStrip->updateTitleWidgets();
+		else
+			section->_tabsLayout->update();
+	}
+
+	_dragStartPos = QPoint();
+	_tabMoving = false;
+	if (cw)
+		cw->_dropOverlay->hideDropOverlay();
+	if (keyboardGrabber() == this)
+		releaseKeyboard();
+}
+
+// Returns the section other than <em>source</em>, whose title area is at <em>globalPos</em>.
+// Docked sections below a floating window are covered by it.
+SectionWidget* SectionTitleWidget::tabStripTargetAt(ContainerWidget* cw, const QPoint& globalPos, SectionWidget* source) const
+{
+	FloatingWidget* fw = cw->floatingDropTargetAt(globalPos, _fw);
+	SectionWidget* sw = fw ? fw->section() : cw->sectionAt(globalPos - _containerGlobalPos);
+	if (!sw || sw == source || !sw->titleAreaGeometry().contains(sw->mapFromGlobal(globalPos)))
+		return NULL;
+	return sw;
+}
+
+// Returns whether <em>globalPos</em> is within the start drag distance of the title area of any section.
+bool SectionTitleWidget::isNearTitleArea(ContainerWidget* cw, const QPoint& globalPos) const
+{
+	const int d = QApplication::startDragDistance();
+	QList<SectionWidget*> sections = cw->_sections;
+	for (int i = 0; i < cw->_floatings.count(); ++i)
+	{
+		FloatingWidget* fw = cw->_floatings.at(i);
+		if (fw != _fw && fw->section() && fw->isVisible())
+			sections.append(fw->section());
+	}
+
+	for (int i = 0; i < sections.count(); ++i)
+	{
+		SectionWidget* sw = sections.at(i);
+		if (sw->titleAreaGeometry().adjusted(-d, -d, d, d).contains(sw->mapFromGlobal(globalPos)))
+			return true;
+	}
+	return false;
+}
+
+// Moves the insertion marker to <em>index</em> of <em>target</em>, NULL hides it.
+void SectionTitleWidget::setTabTarget(SectionWidget* target, int index)
+{
+	if (_tabTarget && _tabTarget != target)
+		_tabTarget->hideTabInsertMarker();
+
+	_tabTarget = target;
+	_tabTargetIndex = index;
+	if (target)
+		target->showTabDropMarker(index);
+}
+
+// Moves the content from <em>source</em> into the tab strip of the target section.
+// Title and content widget are reparented once. Without <em>source</em>, the content
+// comes from the FloatingWidget of a tear-off, which got over the tab strip later.
+void SectionTitleWidget::dropToTabTarget(SectionWidget* source)
+{
+	ContainerWidget* cw = findParentContainerWidget(this);
+	SectionWidget* target = _tabTarget;
+	const int index = _tabTargetIndex;
+	setTabTarget(NULL, -1);
+	delete _dragPreview;
+	_tabMoving = false;
+
+	InternalContentData data;
+	if (!source)
+	{
+		FloatingWidget* fw = _fw;
+		fw->takeContent(data); // Resets _fw
+		cw->recycleFloatingWidget(fw);
+	}
+	else
+	{
+		source->hideTabInsertMarker();
+		if (!source->takeContent(_content->uid(), data))
+		{
+			qWarning() << "THIS SHOULD NOT HAPPEN!!" << _content->uid() << _content->uniqueName();
+			return;
+		}
+	}
+
+	target->addContent(data, true);
+	const int last = target->contents().count() - 1;
+	if (index >= 0 && index < last)
+		target->moveContent(last, index);
+
+	// Delete old section, if it is empty now. The origin of a tear-off goes away on release.
+	if (source && source->contents().isEmpty())
+	{
+		QSplitter* splitter = qobject_cast<QSplitter*>(source->parentWidget());
+		delete source;
+		deleteEmptySplitter(splitter);
+	}
+}
+
 ADS_NAMESPACE_END
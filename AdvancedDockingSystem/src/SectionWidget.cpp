@@ -13,6 +13,10 @@
 #include <QPushButton>
 #include <QScrollBar>
 #include <QMenu>
+#include <QPaintEvent>
+#include <QLabel>
+
+#include <algorithm>
 
 #if defined(ADS_ANIMATIONS_ENABLED)
 #include <QGraphicsDropShadowEffect>
@@ -28,13 +32,21 @@
 
 ADS_NAMESPACE_BEGIN
 
+static const int TabInsertMarkerWidth = 2;
+
 SectionWidget::SectionWidget(ContainerWidget* parent) :
 	QFrame(parent),
 	_uid(GetNextUid()),
 	_container(parent),
 	_tabsLayout(NULL),
 	_tabsLayoutInitCount(0),
+	_tabStrip(NULL),
+	_tabExtentsDirty(true),
+	_tabInsertMarker(NULL),
+	_ghostTab(NULL),
+	_tabsMenuOutdated(false),
 	_contentsLayout(NULL),
+	_sectionMoving(false),
 	_mousePressTitleWidget(NULL)
 {
 	QBoxLayout* l = new QBoxLayout(QBoxLayout::TopToBottom);
@@ -52,15 +64,26 @@ SectionWidget::SectionWidget(ContainerWidget* parent) :
 	_tabsScrollArea = new SectionWidgetTabsScrollArea(this);
 	_topLayout->addWidget(_tabsScrollArea, 1);
 
-	_tabsContainerWidget = new QWidget();
-	_tabsContainerWidget->setObjectName("tabsContainerWidget");
-	_tabsScrollArea->setWidget(_tabsContainerWidget);
-
-	_tabsLayout = new QBoxLayout(QBoxLayout::LeftToRight);
-	_tabsLayout->setContentsMargins(0, 0, 0, 0);
-	_tabsLayout->setSpacing(0);
-	_tabsLayout->addStretch(1);
-	_tabsContainerWidget->setLayout(_tabsLayout);
+	if (_container && _container->isVirtualTabsEnabled())
+	{
+		_tabStrip = new SectionTabStrip(this);
+		_tabsContainerWidget = _tabStrip;
+		_tabsContainerWidget->setObjectName("tabsContainerWidget");
+		_tabsScrollArea->setWidget(_tabsContainerWidget);
+	}
+	else
+	{
+		_tabsContainerWidget = new QWidget();
+		_tabsContainerWidget->setObjectName("tabsContainerWidget");
+		_tabsScrollArea->setWidget(_tabsContainerWidget);
+
+		_tabsLayout = new QBoxLayout(QBoxLayout::LeftToRight);
+		_tabsLayout->setContentsMargins(0, 0, 0, 0);
+		_tabsLayout->setSpacing(0);
+		_tabsLayout->addStretch(1);
+		_tabsContainerWidget->setLayout(_tabsLayout);
+		_tabsContainerWidget->installEventFilter(this); // Invalidates the tab extents on relayout
+	}
 
 	_tabsMenuButton = new QPushButton();
 	_tabsMenuButton->setObjectName("tabsMenuButton");
@@ -74,6 +97,17 @@ SectionWidget::SectionWidget(ContainerWidget* parent) :
 	//QObject::connect(_tabsMenuButton, SIGNAL(clicked()), this, SLOT(onTabsMenuButtonClicked()));
 #endif
 
+	// The entries of the menu are created on demand, right before it shows up.
+	_tabsMenu = new QMenu(this);
+	_tabsMenuButton->setMenu(_tabsMenu);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	QObject::connect(_tabsMenu, &QMenu::aboutToShow, this, &SectionWidget::buildTabsMenu);
+	QObject::connect(_tabsMenu, &QMenu::triggered, this, &SectionWidget::onTabsMenuActionTriggered);
+#else
+	QObject::connect(_tabsMenu, SIGNAL(aboutToShow()), this, SLOT(buildTabsMenu()));
+	QObject::connect(_tabsMenu, SIGNAL(triggered(QAction*)), this, SLOT(onTabsMenuActionTriggered(QAction*)));
+#endif
+
 	_closeButton = new QPushButton();
 	_closeButton->setObjectName("closeButton");
 	_closeButton->setFlat(true);
@@ -87,7 +121,8 @@ SectionWidget::SectionWidget(ContainerWidget* parent) :
 	QObject::connect(_closeButton, SIGNAL(clicked(bool)), this, SLOT(onCloseButtonClicked()));
 #endif
 
-	_tabsLayoutInitCount = _tabsLayout->count();
+	if (_tabsLayout)
+		_tabsLayoutInitCount = _tabsLayout->count();
 
 	/* central area with contents */
 
@@ -104,6 +139,7 @@ SectionWidget::SectionWidget(ContainerWidget* parent) :
 #endif
 
 	SWLookupMapById(_container).insert(_uid, this);
+	installEventFilter(_container); // Keeps the layout tree up to date on resize
 }
 
 SectionWidget::~SectionWidget()
@@ -112,6 +148,27 @@ SectionWidget::~SectionWidget()
 	{
 		SWLookupMapById(_container).remove(_uid);
 		_container->_sections.removeAll(this); // Note: I don't like this here, but we have to remove it from list...
+		_container->_sectionIndexDirty = true;
+
+		// Forget locations which still point to this section.
+		for (int i = 0; i < _contents.count(); ++i)
+		{
+			const int uid = _contents.at(i)->uid();
+			if (SCLocationMapById(_container).value(uid).section == this)
+				SCLocationMapById(_container).remove(uid);
+		}
+	}
+
+	// Delete the tabbed floating window, there is nothing left to show.
+	FloatingWidget* fw = qobject_cast<FloatingWidget*>(parentWidget());
+	if (fw && fw->_section == this)
+	{
+		fw->_section = NULL;
+		if (_container)
+			_container->_floatings.removeAll(fw);
+		fw->hide();
+		fw->deleteLater();
+		return;
 	}
 
 	// Delete empty QSplitter.
@@ -148,7 +205,13 @@ void SectionWidget::addContent(const SectionContent::RefPtr& c)
 
 	SectionTitleWidget* title = new SectionTitleWidget(c, NULL);
 	_sectionTitles.append(title);
-	_tabsLayout->insertWidget(_tabsLayout->count() - _tabsLayoutInitCount, title);
+	if (_tabStrip)
+	{
+		title->setParent(_tabStrip);
+		_tabStrip->insertTab(_contents.count() - 1);
+	}
+	else
+		_tabsLayout->insertWidget(_tabsLayout->count() - _tabsLayoutInitCount, title);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 	QObject::connect(title, &SectionTitleWidget::clicked, this, &SectionWidget::onSectionTitleClicked);
 #else
@@ -159,6 +222,8 @@ void SectionWidget::addContent(const SectionContent::RefPtr& c)
 	_sectionContents.append(content);
 	_contentsLayout->addWidget(content);
 
+	updateContentLocations(_contents.count() - 1);
+
 	// Active first TAB.
 	if (_contents.size() == 1)
 		setCurrentIndex(0);
@@ -176,8 +241,17 @@ void SectionWidget::addContent(const InternalContentData& data, bool autoActivat
 	// Add title-widget to tab-bar
 	// #FIX: Make it visible, since it is possible that it was hidden previously.
 	_sectionTitles.append(data.titleWidget);
-	_tabsLayout->insertWidget(_tabsLayout->count() - _tabsLayoutInitCount, data.titleWidget);
-	data.titleWidget->setVisible(true);
+	if (_tabStrip)
+	{
+		// The strip decides about the visibility.
+		data.titleWidget->setParent(_tabStrip);
+		_tabStrip->insertTab(_contents.count() - 1);
+	}
+	else
+	{
+		_tabsLayout->insertWidget(_tabsLayout->count() - _tabsLayoutInitCount, data.titleWidget);
+		data.titleWidget->setVisible(true);
+	}
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 	QObject::connect(data.titleWidget, &SectionTitleWidget::clicked, this, &SectionWidget::onSectionTitleClicked);
 #else
@@ -189,6 +263,8 @@ void SectionWidget::addContent(const InternalContentData& data, bool autoActivat
 	_sectionContents.append(data.contentWidget);
 	_contentsLayout->addWidget(data.contentWidget);
 
+	updateContentLocations(_contents.count() - 1);
+
 	// Activate first TAB.
 	if (_contents.size() == 1)
 		setCurrentIndex(0);
@@ -197,7 +273,11 @@ void SectionWidget::addContent(const InternalContentData& data, bool autoActivat
 		setCurrentIndex(_contents.count() - 1);
 	// Mark it as inactive tab.
 	else
+	{
 		data.titleWidget->setActiveTab(false); // or: setCurrentIndex(currentIndex())
+		if (_tabStrip)
+			_tabStrip->updateTitleWidgets();
+	}
 
 	updateTabsMenu();
 }
@@ -205,24 +285,24 @@ void SectionWidget::addContent(const InternalContentData& data, bool autoActivat
 bool SectionWidget::takeContent(int uid, InternalContentData& data)
 {
 	// Find SectionContent.
-	SectionContent::RefPtr sc;
-	int index = -1;
-	for (int i = 0; i < _contents.count(); i++)
-	{
-		if (_contents[i]->uid() != uid)
-			continue;
-		index = i;
-		sc = _contents.takeAt(i);
-		break;
-	}
-	if (!sc)
+	const int index = indexOfContentByUid(uid);
+	if (index < 0)
 		return false;
+	SectionContent::RefPtr sc = _contents.takeAt(index);
+
+	// Following tabs moved one index to the left.
+	if (_container)
+		SCLocationMapById(_container).remove(uid);
+	updateContentLocations(index);
 
 	// Title wrapper widget (TAB)
 	SectionTitleWidget* title = _sectionTitles.takeAt(index);
 	if (title)
 	{
-		_tabsLayout->removeWidget(title);
+		if (_tabStrip)
+			_tabStrip->removeTab(index);
+		else
+			_tabsLayout->removeWidget(title);
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 		title->setAttribute(Qt::WA_WState_Created, false); /* fix: floating rubberband #16 */
 #endif
@@ -261,11 +341,21 @@ bool SectionWidget::takeContent(int uid, InternalContentData& data)
 
 int SectionWidget::indexOfContent(const SectionContent::RefPtr& c) const
 {
-	return _contents.indexOf(c);
+	if (c.isNull())
+		return -1;
+	return indexOfContentByUid(c->uid());
 }
 
 int SectionWidget::indexOfContentByUid(int uid) const
 {
+	if (_container)
+	{
+		const ContentLocation loc = SCLocationMapById(_container).value(uid);
+		if (loc.type == ContentLocation::SectionLocation && loc.section == this)
+			return loc.index;
+		return -1;
+	}
+
 	for (int i = 0; i < _contents.count(); ++i)
 	{
 		if (_contents[i]->uid() == uid)
@@ -277,14 +367,24 @@ int SectionWidget::indexOfContentByUid(int uid) const
 int SectionWidget::indexOfContentByTitlePos(const QPoint& p, QWidget* exclude) const
 {
 	int index = -1;
-	for (int i = 0; i < _sectionTitles.size(); ++i)
+	if (_tabStrip)
+	{
+		index = _tabStrip->tabAt(_tabStrip->mapFrom(this, p));
+	}
+	else
 	{
-		if (_sectionTitles[i]->geometry().contains(p) && (exclude == NULL || _sectionTitles[i] != exclude))
+		// Binary search in the slots of the tabs, which are not affected by a moving title.
+		const QPoint pos = _tabsContainerWidget->mapFrom(this, p);
+		const QVector<int>& extents = tabExtents();
+		if (pos.x() >= 0 && pos.y() >= 0 && pos.y() < _tabsContainerWidget->height())
 		{
-			index = i;
-			break;
+			index = std::upper_bound(extents.constBegin(), extents.constEnd(), pos.x()) - extents.constBegin();
+			if (index >= extents.count())
+				index = -1;
 		}
 	}
+	if (index >= 0 && exclude != NULL && _sectionTitles.value(index) == exclude)
+		index = -1;
 	return index;
 }
 
@@ -298,7 +398,10 @@ void SectionWidget::moveContent(int from, int to)
 	if (from >= _contents.size() || from < 0 || to >= _contents.size() || to < 0 || from == to)
 	{
 		qDebug() << "Invalid index for tab movement" << from << to;
-		_tabsLayout->update();
+		if (_tabStrip)
+			_tabStrip->updateTitleWidgets();
+		else
+			_tabsLayout->update();
 		return;
 	}
 
@@ -307,25 +410,96 @@ void SectionWidget::moveContent(int from, int to)
 	_sectionContents.move(from, to);
 
 	QLayoutItem* liFrom = NULL;
-	liFrom = _tabsLayout->takeAt(from);
+	if (_tabStrip)
+	{
+		_tabStrip->moveTab(from, to);
+	}
+	else
+	{
+		liFrom = _tabsLayout->takeAt(from);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-	_tabsLayout->insertItem(to, liFrom);
+		_tabsLayout->insertItem(to, liFrom);
 #else
-	_tabsLayout->insertWidget(to, liFrom->widget());
-	delete liFrom;
-	liFrom = NULL;
+		_tabsLayout->insertWidget(to, liFrom->widget());
+		delete liFrom;
+		liFrom = NULL;
 #endif
+	}
 
 	liFrom = _contentsLayout->takeAt(from);
 	_contentsLayout->insertWidget(to, liFrom->widget());
 	delete liFrom;
 
+	updateContentLocations(qMin(from, to));
 	updateTabsMenu();
 }
 
+bool SectionWidget::eventFilter(QObject* watched, QEvent* e)
+{
+	if (watched == _tabsContainerWidget
+			&& (e->type() == QEvent::LayoutRequest || e->type() == QEvent::Resize))
+	{
+		_tabExtentsDirty = true;
+	}
+	return QFrame::eventFilter(watched, e);
+}
+
 void SectionWidget::showEvent(QShowEvent*)
 {
-	_tabsScrollArea->ensureWidgetVisible(_sectionTitles.at(currentIndex()));
+	if (_tabStrip)
+		_tabStrip->ensureTabVisible(currentIndex());
+	else
+		_tabsScrollArea->ensureWidgetVisible(_sectionTitles.at(currentIndex()));
+}
+
+// Presses on the empty part of the title area (not consumed by a tab or button)
+// move the whole section, see ContainerWidget::moveSection().
+void SectionWidget::mousePressEvent(QMouseEvent* ev)
+{
+	if (ev->button() == Qt::LeftButton && _container && _container->_sections.contains(this)
+			&& titleAreaGeometry().contains(ev->pos()))
+	{
+		ev->accept();
+		_mousePressPoint = ev->pos();
+		return;
+	}
+	QFrame::mousePressEvent(ev);
+}
+
+void SectionWidget::mouseMoveEvent(QMouseEvent* ev)
+{
+	if (!_mousePressPoint.isNull() && (ev->buttons() & Qt::LeftButton))
+	{
+		ev->accept();
+		if (!_sectionMoving && (ev->pos() - _mousePressPoint).manhattanLength() < QApplication::startDragDistance())
+			return;
+
+		_sectionMoving = true;
+		SectionWidget* target = NULL;
+		sectionDropTargetAt(ev->globalPos(), target);
+		return;
+	}
+	QFrame::mouseMoveEvent(ev);
+}
+
+void SectionWidget::mouseReleaseEvent(QMouseEvent* ev)
+{
+	_mousePressPoint = QPoint();
+	if (_sectionMoving)
+	{
+		ev->accept();
+		_sectionMoving = false;
+
+		SectionWidget* target = NULL;
+		const DropArea area = sectionDropTargetAt(ev->globalPos(), target);
+		_container->_dropOverlay->hideDropOverlay();
+
+		// Note: Merging into another section deletes this one later.
+		if (area != InvalidDropArea)
+			_container->moveSection(this, target, area);
+		return;
+	}
+	QFrame::mouseReleaseEvent(ev);
 }
 
 void SectionWidget::setCurrentIndex(int index)
@@ -336,32 +510,31 @@ void SectionWidget::setCurrentIndex(int index)
 		return;
 	}
 
-	// Set active TAB
-	for (int i = 0; i < _tabsLayout->count(); ++i)
-	{
-		QLayoutItem* item = _tabsLayout->itemAt(i);
-		if (item->widget())
-		{
-			SectionTitleWidget* stw = dynamic_cast<SectionTitleWidget*>(item->widget());
-			if (stw)
-			{
-				if (i == index)
-				{
-					stw->setActiveTab(true);
-					_tabsScrollArea->ensureWidgetVisible(stw);
-					if (stw->_content->flags().testFlag(SectionContent::Closeable))
-						_closeButton->setEnabled(true);
-					else
-						_closeButton->setEnabled(false);
-				}
-				else
-					stw->setActiveTab(false);
-			}
-		}
-	}
+	// Set active TAB, only the previous and the new title are touched.
+	// The previous title is left alone, if it has been moved into another section meanwhile.
+	SectionTitleWidget* stw = _sectionTitles.at(index);
+	if (_activeTitleWidget && _activeTitleWidget != stw && indexOfContent(_activeTitleWidget->_content) >= 0)
+		_activeTitleWidget->setActiveTab(false);
+	_activeTitleWidget = stw;
+	stw->setActiveTab(true);
+	if (stw->_content->flags().testFlag(SectionContent::Closeable))
+		_closeButton->setEnabled(true);
+	else
+		_closeButton->setEnabled(false);
 
 	// Set active CONTENT
 	_contentsLayout->setCurrentIndex(index);
+
+	if (_tabStrip)
+	{
+		_tabStrip->updateTitleWidgets();
+		_tabStrip->ensureTabVisible(index);
+	}
+	else
+		_tabsScrollArea->ensureWidgetVisible(stw);
+
+	if (_container)
+		_container->invalidateLayoutTree();
 }
 
 void SectionWidget::onSectionTitleClicked()
@@ -369,7 +542,7 @@ void SectionWidget::onSectionTitleClicked()
 	SectionTitleWidget* stw = qobject_cast<SectionTitleWidget*>(sender());
 	if (stw)
 	{
-		int index = _tabsLayout->indexOf(stw);
+		int index = indexOfContent(stw->_content);
 		setCurrentIndex(index);
 	}
 }
@@ -385,9 +558,8 @@ void SectionWidget::onCloseButtonClicked()
 	_container->hideSectionContent(sc);
 }
 
-void SectionWidget::onTabsMenuActionTriggered(bool)
+void SectionWidget::onTabsMenuActionTriggered(QAction* a)
 {
-	QAction* a = qobject_cast<QAction*>(sender());
 	if (a)
 	{
 		const int uid = a->data().toInt();
@@ -399,21 +571,203 @@ void SectionWidget::onTabsMenuActionTriggered(bool)
 
 void SectionWidget::updateTabsMenu()
 {
-	QMenu* m = new QMenu();
+	_tabsMenuOutdated = true;
+}
+
+void SectionWidget::buildTabsMenu()
+{
+	if (!_tabsMenuOutdated)
+		return;
+	_tabsMenuOutdated = false;
+
+	_tabsMenu->clear();
 	for (int i = 0; i < _contents.count(); ++i)
 	{
 		const SectionContent::RefPtr& sc = _contents.at(i);
-		QAction* a = m->addAction(QIcon(), sc->visibleTitle());
+		QAction* a = _tabsMenu->addAction(QIcon(), sc->visibleTitle());
 		a->setData(sc->uid());
-#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
-		QObject::connect(a, &QAction::triggered, this, &SectionWidget::onTabsMenuActionTriggered);
-#else
-		QObject::connect(a, SIGNAL(triggered(bool)), this, SLOT(onTabsMenuActionTriggered(bool)));
-#endif
 	}
-	QMenu* old = _tabsMenuButton->menu();
-	_tabsMenuButton->setMenu(m);
-	delete old;
+}
+
+void SectionWidget::updateContentLocations(int fromIndex)
+{
+	if (!_container)
+		return;
+
+	_container->invalidateLayoutTree();
+	for (int i = qMax(fromIndex, 0); i < _contents.count(); ++i)
+	{
+		ContentLocation& loc = SCLocationMapById(_container)[_contents.at(i)->uid()];
+		loc.type = ContentLocation::SectionLocation;
+		loc.section = this;
+		loc.floating = NULL;
+		loc.index = i;
+	}
+}
+
+// Shows the drop overlay for a move of this section to "globalPos" and returns the area,
+// "target" is NULL for the outer areas of the container.
+DropArea SectionWidget::sectionDropTargetAt(const QPoint& globalPos, SectionWidget*& target) const
+{
+	DropOverlay* overlay = _container->_dropOverlay;
+	const QPoint pos = _container->mapFromGlobal(globalPos);
+	target = _container->sectionAt(pos);
+	if (target == this)
+	{
+		target = NULL;
+		overlay->hideDropOverlay();
+		return InvalidDropArea;
+	}
+	if (target)
+	{
+		overlay->setAllowedAreas(AllAreas);
+		return overlay->showDropOverlay(target, globalPos);
+	}
+
+	DropArea area = InvalidDropArea;
+	QRect rect;
+	if (_container->outerTopDropRect().contains(pos))
+	{
+		area = TopDropArea;
+		rect = _container->outerTopDropRect();
+	}
+	else if (_container->outerRightDropRect().contains(pos))
+	{
+		area = RightDropArea;
+		rect = _container->outerRightDropRect();
+	}
+	else if (_container->outerBottomDropRect().contains(pos))
+	{
+		area = BottomDropArea;
+		rect = _container->outerBottomDropRect();
+	}
+	else if (_container->outerLeftDropRect().contains(pos))
+	{
+		area = LeftDropArea;
+		rect = _container->outerLeftDropRect();
+	}
+
+	if (area == InvalidDropArea)
+	{
+		overlay->hideDropOverlay();
+		return InvalidDropArea;
+	}
+	overlay->setAllowedAreas(area);
+	overlay->showDropOverlay(_container, rect);
+	return area;
+}
+
+// Returns the right edge of each tab in _tabsLayout. The extents are summed up
+// from the widths, because a title which is moved by the user leaves its slot.
+const QVector<int>& SectionWidget::tabExtents() const
+{
+	if (_tabExtentsDirty || _tabExtents.count() != _sectionTitles.count())
+	{
+		_tabExtents.resize(_sectionTitles.count());
+		int x = 0;
+		for (int i = 0; i < _sectionTitles.count(); ++i)
+		{
+			x += _sectionTitles.at(i)->width();
+			_tabExtents[i] = x;
+		}
+		_tabExtentsDirty = false;
+	}
+	return _tabExtents;
+}
+
+QRect SectionWidget::tabSlotGeometry(int index) const
+{
+	if (_tabStrip)
+		return _tabStrip->tabRect(index);
+
+	const QVector<int>& extents = tabExtents();
+	if (index < 0 || index >= extents.count())
+		return QRect();
+	const int left = index > 0 ? extents.at(index - 1) : 0;
+	return QRect(left, 0, extents.at(index) - left, _tabsContainerWidget->height());
+}
+
+// Shows where a tab moved from index "from" gets inserted. Moving to the right
+// inserts it after the tab at "to", moving to the left before it.
+void SectionWidget::showTabInsertMarker(int from, int to)
+{
+	const QRect slot = tabSlotGeometry(to);
+	if (from < 0 || from == to || !slot.isValid())
+	{
+		hideTabInsertMarker();
+		return;
+	}
+	placeTabInsertMarker((to > from) ? slot.right() + 1 - TabInsertMarkerWidth : slot.left());
+}
+
+// Returns the index at which a tab of another section, dropped at "pos", gets inserted.
+// The left half of a tab inserts in front of it, the right half behind it.
+int SectionWidget::tabInsertIndexAt(const QPoint& pos) const
+{
+	const int index = indexOfContentByTitlePos(pos);
+	if (index < 0)
+		return _contents.count();
+
+	const QWidget* tabs = _tabStrip ? static_cast<QWidget*>(_tabStrip) : _tabsContainerWidget;
+	const QRect slot = tabSlotGeometry(index);
+	return (tabs->mapFrom(this, pos).x() < slot.center().x()) ? index : index + 1;
+}
+
+// Shows where a tab of another section gets inserted, in front of
+// the tab at "index" or behind the last tab.
+void SectionWidget::showTabDropMarker(int index)
+{
+	if (_contents.isEmpty())
+	{
+		hideTabInsertMarker();
+		return;
+	}
+	if (index < _contents.count())
+		placeTabInsertMarker(tabSlotGeometry(index).left());
+	else
+		placeTabInsertMarker(tabSlotGeometry(_contents.count() - 1).right() + 1 - TabInsertMarkerWidth);
+}
+
+void SectionWidget::placeTabInsertMarker(int x)
+{
+	if (!_tabInsertMarker)
+	{
+		_tabInsertMarker = new QWidget(_tabsContainerWidget);
+		_tabInsertMarker->setObjectName("tabInsertMarker");
+		_tabInsertMarker->setAutoFillBackground(true);
+		_tabInsertMarker->setBackgroundRole(QPalette::Highlight);
+	}
+	_tabInsertMarker->setGeometry(x, 0, TabInsertMarkerWidth, _tabsContainerWidget->height());
+	_tabInsertMarker->show();
+	_tabInsertMarker->raise();
+}
+
+void SectionWidget::hideTabInsertMarker()
+{
+	if (_tabInsertMarker)
+		_tabInsertMarker->hide();
+}
+
+// Shows a disabled placeholder of the dragged tab in the otherwise empty tab strip.
+// It is no part of any layout, the section keeps its geometry until the drop.
+void SectionWidget::showGhostTab(const QString& title)
+{
+	if (!_ghostTab)
+	{
+		_ghostTab = new QLabel(_tabsContainerWidget);
+		_ghostTab->setObjectName("ghostTab");
+		_ghostTab->setEnabled(false);
+		_ghostTab->setMargin(4);
+	}
+	_ghostTab->setText(title);
+	_ghostTab->setGeometry(0, 0, _ghostTab->sizeHint().width(), _tabsContainerWidget->height());
+	_ghostTab->show();
+}
+
+void SectionWidget::hideGhostTab()
+{
+	if (_ghostTab)
+		_ghostTab->hide();
 }
 
 int SectionWidget::GetNextUid()
@@ -455,4 +809,204 @@ void SectionWidgetTabsScrollArea::wheelEvent(QWheelEvent* e)
 		horizontalScrollBar()->setValue(horizontalScrollBar()->value() - 20);
 }
 
+/*****************************************************************************/
+
+static const int TabPadding = 8; // Horizontal space around the title text of a painted tab
+
+SectionTabStrip::SectionTabStrip(SectionWidget* sectionWidget) :
+	QWidget(),
+	_sectionWidget(sectionWidget),
+	_hoverIndex(-1)
+{
+	_tabOffsets.append(0);
+	setMouseTracking(true);
+	setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+}
+
+SectionTabStrip::~SectionTabStrip()
+{
+}
+
+void SectionTabStrip::insertTab(int index)
+{
+	_tabWidths.insert(index, tabWidth(index));
+	_tabOffsets.insert(index + 1, 0);
+	updateOffsets(index);
+}
+
+void SectionTabStrip::removeTab(int index)
+{
+	_tabWidths.remove(index);
+	_tabOffsets.remove(index + 1);
+	updateOffsets(index);
+}
+
+void SectionTabStrip::moveTab(int from, int to)
+{
+	const int width = _tabWidths.at(from);
+	_tabWidths.remove(from);
+	_tabWidths.insert(to, width);
+	updateOffsets(qMin(from, to));
+}
+
+int SectionTabStrip::count() const
+{
+	return _tabWidths.count();
+}
+
+int SectionTabStrip::tabAt(const QPoint& pos) const
+{
+	if (pos.x() < 0 || pos.x() >= _tabOffsets.last() || pos.y() < 0 || pos.y() >= height())
+		return -1;
+	return (std::upper_bound(_tabOffsets.constBegin(), _tabOffsets.constEnd(), pos.x()) - _tabOffsets.constBegin()) - 1;
+}
+
+QRect SectionTabStrip::tabRect(int index) const
+{
+	if (index < 0 || index >= _tabWidths.count())
+		return QRect();
+	return QRect(_tabOffsets.at(index), 0, _tabWidths.at(index), height());
+}
+
+void SectionTabStrip::ensureTabVisible(int index)
+{
+	const QRect r = tabRect(index);
+	if (r.isValid())
+		_sectionWidget->_tabsScrollArea->ensureVisible(r.center().x(), r.center().y(), r.width() / 2 + 1, 0);
+}
+
+// Shows the title widgets of the current and the hovered tab and hides all others.
+// Title widgets, which are pressed or moved by the user, keep their state.
+void SectionTabStrip::updateTitleWidgets()
+{
+	const QList<SectionTitleWidget*>& titles = _sectionWidget->_sectionTitles;
+	QList<QPointer<SectionTitleWidget> > shown;
+
+	const int indexes[] = { _sectionWidget->currentIndex(), _hoverIndex };
+	for (int i = 0; i < 2; ++i)
+	{
+		SectionTitleWidget* stw = titles.value(indexes[i]);
+		if (!stw || stw->parentWidget() != this || shown.contains(stw))
+			continue;
+		if (!stw->_tabMoving)
+			stw->setGeometry(tabRect(indexes[i]));
+		stw->show();
+		shown.append(stw);
+	}
+
+	for (int i = 0; i < _shownTitleWidgets.count(); ++i)
+	{
+		SectionTitleWidget* stw = _shownTitleWidgets.at(i);
+		if (!stw || stw->parentWidget() != this || shown.contains(stw))
+			continue;
+		if (stw->_tabMoving || !stw->_dragStartPos.isNull())
+			shown.append(stw);
+		else
+			stw->hide();
+	}
+	_shownTitleWidgets = shown;
+	update();
+}
+
+QSize SectionTabStrip::sizeHint() const
+{
+	return QSize(_tabOffsets.last(), fontMetrics().height() + TabPadding);
+}
+
+QSize SectionTabStrip::minimumSizeHint() const
+{
+	return sizeHint();
+}
+
+void SectionTabStrip::paintEvent(QPaintEvent* e)
+{
+	const QRect r = e->rect();
+	if (r.left() >= _tabOffsets.last())
+		return;
+
+	QPainter p(this);
+	const int first = qMax(tabAt(QPoint(qMax(r.left(), 0), 0)), 0);
+	for (int i = first; i < _tabWidths.count() && _tabOffsets.at(i) <= r.right(); ++i)
+	{
+		SectionTitleWidget* stw = _sectionWidget->_sectionTitles.value(i);
+		if (stw && stw->isVisible())
+			continue;
+
+		const QRect tr = tabRect(i);
+		p.setPen(palette().color(QPalette::Mid));
+		p.drawLine(tr.topRight(), tr.bottomRight());
+		p.setPen(palette().color(QPalette::WindowText));
+		p.drawText(tr.adjusted(TabPadding, 0, -TabPadding, 0), Qt::AlignLeft | Qt::AlignVCenter, _sectionWidget->_contents.at(i)->visibleTitle());
+	}
+}
+
+// A painted tab has no title widget to receive the press, e.g. without a hover move before
+// or with touch input. Only the empty part of the strip starts a section drag.
+void SectionTabStrip::mousePressEvent(QMouseEvent* e)
+{
+	const int index = tabAt(e->pos());
+	if (e->button() == Qt::LeftButton && index >= 0)
+	{
+		e->accept();
+		_hoverIndex = index;
+		_sectionWidget->setCurrentIndex(index);
+		updateTitleWidgets();
+		return;
+	}
+	QWidget::mousePressEvent(e);
+}
+
+void SectionTabStrip::mouseMoveEvent(QMouseEvent* e)
+{
+	const int index = tabAt(e->pos());
+	if (index != _hoverIndex)
+	{
+		_hoverIndex = index;
+		updateTitleWidgets();
+	}
+	QWidget::mouseMoveEvent(e);
+}
+
+void SectionTabStrip::leaveEvent(QEvent* e)
+{
+	if (_hoverIndex != -1)
+	{
+		_hoverIndex = -1;
+		updateTitleWidgets();
+	}
+	QWidget::leaveEvent(e);
+}
+
+void SectionTabStrip::changeEvent(QEvent* e)
+{
+	if (e->type() == QEvent::FontChange)
+	{
+		for (int i = 0; i < _tabWidths.count(); ++i)
+			_tabWidths[i] = tabWidth(i);
+		updateOffsets(0);
+	}
+	QWidget::changeEvent(e);
+}
+
+int SectionTabStrip::tabWidth(int index) const
+{
+	const QString title = _sectionWidget->_contents.at(index)->visibleTitle();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+	return fontMetrics().horizontalAdvance(title) + 2 * TabPadding;
+#else
+	return fontMetrics().width(title) + 2 * TabPadding;
+#endif
+}
+
+// Recalculates the offsets of all tabs starting at "fromIndex", appending a tab is O(1).
+void SectionTabStrip::updateOffsets(int fromIndex)
+{
+	for (int i = qMax(fromIndex, 0); i < _tabWidths.count(); ++i)
+		_tabOffsets[i + 1] = _tabOffsets.at(i) + _tabWidths.at(i);
+
+	_hoverIndex = -1;
+	updateGeometry();
+	updateTitleWidgets();
+}
+
 ADS_NAMESPACE_END
@@ -10,5 +10,7 @@ INCLUDEPATH += $$PWD/src
 INCLUDEPATH += $$PWD/../AdvancedDockingSystem/include
 DEPENDPATH += $$PWD/../AdvancedDockingSystem/include
 
+RESOURCES += $$PWD/../AdvancedDockingSystem/res/ads.qrc
+
 include(AdvancedDockingSystemUnitTests.pri)
 include(../AdvancedDockingSystem/AdvancedDockingSystem.pri)
\ No newline at end of file
@@ -1,7 +1,189 @@
 #include "TestCore.h"
 
+#include <QLabel>
+#include <QSplitter>
+#include <QMenu>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QApplication>
+#include <QPixmap>
+
 #include "ads/API.h"
+#include "ads/ContainerWidget.h"
+#include "ads/SectionContent.h"
+#include "ads/SectionWidget.h"
+#include "ads/SectionTitleWidget.h"
+#include "ads/DropOverlay.h"
+#include "ads/FloatingWidget.h"
 #include "ads/Serialization.h"
+#include "ads/DockLayoutTree.h"
+#include "ads/DockLayoutGeometry.h"
+
+// Empty splitter cleanup as it has been done before the splitter tree was collapsed locally.
+// Used as reference in benchmarks.
+static bool legacySplitterContainsSectionWidget(QSplitter* splitter)
+{
+	for (int i = 0; i < splitter->count(); ++i)
+	{
+		QWidget* w = splitter->widget(i);
+		QSplitter* sp = qobject_cast<QSplitter*>(w);
+		if (sp && legacySplitterContainsSectionWidget(sp))
+			return true;
+		else if (qobject_cast<ADS_NS::SectionWidget*>(w) != NULL)
+			return true;
+	}
+	return false;
+}
+
+static void legacyDeleteEmptySplitter(ADS_NS::ContainerWidget* container)
+{
+	bool doAgain = false;
+	do
+	{
+		doAgain = false;
+		QList<QSplitter*> splitters = container->findChildren<QSplitter*>();
+		for (int i = 0; i < splitters.count(); ++i)
+		{
+			QSplitter* sp = splitters.at(i);
+			if (!sp->property("ads-splitter").toBool())
+				continue;
+			if (sp->count() > 0 && legacySplitterContainsSectionWidget(sp))
+				continue;
+			delete splitters[i];
+			doAgain = true;
+			break;
+		}
+	}
+	while (doAgain);
+}
+
+// Section lookup as it has been done before the rectangle index.
+// Used as reference in benchmarks.
+static ADS_NS::SectionWidget* legacySectionAt(ADS_NS::ContainerWidget* container, const QList<ADS_NS::SectionWidget*>& sections, const QPoint& pos)
+{
+	const QPoint gpos = container->mapToGlobal(pos);
+	foreach (ADS_NS::SectionWidget* sw, sections)
+	{
+		if (sw->rect().contains(sw->mapFromGlobal(gpos)))
+			return sw;
+	}
+	return NULL;
+}
+
+// Shows the top level widget "w" and waits until it is on screen.
+static bool showAndWait(QWidget& w)
+{
+	w.show();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	return QTest::qWaitForWindowExposed(&w);
+#else
+	return QTest::qWaitForWindowShown(&w);
+#endif
+}
+
+// Creates the content "uname-<n>" with the title "<n>".
+static ADS_NS::SectionContent::RefPtr newNumberedContent(ADS_NS::ContainerWidget& cw, int n)
+{
+	return ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(n), &cw, new QLabel(QString::number(n)), new QLabel(QString("Content %1").arg(n)));
+}
+
+// Creates a grid of "rows" x "columns" sections.
+static void createSectionGrid(ADS_NS::ContainerWidget& cw, int rows, int columns)
+{
+	ADS_NS::SectionWidget* rowSection = NULL;
+	for (int r = 0; r < rows; ++r)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1-0").arg(r), &cw, new QLabel("Title"), new QLabel("Content"));
+		rowSection = cw.addSectionContent(sc, rowSection, ADS_NS::BottomDropArea);
+		ADS_NS::SectionWidget* sw = rowSection;
+		for (int c = 1; c < columns; ++c)
+		{
+			sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1-%2").arg(r).arg(c), &cw, new QLabel("Title"), new QLabel("Content"));
+			sw = cw.addSectionContent(sc, sw, ADS_NS::RightDropArea);
+		}
+	}
+}
+
+// Counts the created content widgets.
+class CountingContentFactory : public ADS_NS::SectionContentFactory
+{
+public:
+	CountingContentFactory() : created(0) {}
+
+	virtual QWidget* createContentWidget(const QString& uniqueName)
+	{
+		++created;
+		return new QLabel(uniqueName);
+	}
+
+	virtual QByteArray saveContentState(const QString& uniqueName, QWidget* widget)
+	{
+		Q_UNUSED(uniqueName)
+		return static_cast<QLabel*>(widget)->text().toUtf8();
+	}
+
+	virtual void restoreContentState(const QString& uniqueName, QWidget* widget, const QByteArray& state)
+	{
+		Q_UNUSED(uniqueName)
+		static_cast<QLabel*>(widget)->setText(QString::fromUtf8(state));
+	}
+
+	int created;
+};
+
+// Counts show and hide events of the watched widgets.
+class ShowHideCounter : public QObject
+{
+public:
+	ShowHideCounter() : shown(0), hidden(0) {}
+
+	virtual bool eventFilter(QObject* obj, QEvent* e)
+	{
+		if (e->type() == QEvent::Show)
+			++shown;
+		else if (e->type() == QEvent::Hide)
+			++hidden;
+		return QObject::eventFilter(obj, e);
+	}
+
+	int shown;
+	int hidden;
+};
+
+// Sends a mouse event with global position <em>globalPos</em> to <em>w</em>.
+static void sendMouseEvent(QWidget* w, QEvent::Type type, const QPoint& globalPos, Qt::MouseButton button, Qt::MouseButtons buttons)
+{
+	QMouseEvent ev(type, w->mapFromGlobal(globalPos), globalPos, button, buttons, Qt::NoModifier);
+	QApplication::sendEvent(w, &ev);
+}
+
+// Drags the title widget of <em>sc</em> along <em>path</em> (global positions) and releases it.
+static void dragTitle(const ADS_NS::SectionContent::RefPtr& sc, const QList<QPoint>& path)
+{
+	QWidget* title = sc->titleWidget()->parentWidget();
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	for (int i = 0; i < path.count(); ++i)
+		sendMouseEvent(title, QEvent::MouseMove, path.at(i), Qt::NoButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseButtonRelease, path.last(), Qt::LeftButton, Qt::NoButton);
+}
+
+// Collects the section ids and resets the splitter sizes, which depend on the widget geometry.
+static void stripLayoutNode(ADS_NS::DockLayoutNode& node, QList<int>& sectionIds)
+{
+	node.sizes.clear();
+	if (node.type == ADS_NS::DockLayoutNode::SectionNode)
+		sectionIds.append(node.sectionId);
+	for (int i = 0; i < node.children.count(); ++i)
+		stripLayoutNode(node.children[i], sectionIds);
+}
+
+// Runs after every test function, even a failed one.
+void TestCore::cleanup()
+{
+	qApp->setStyleSheet(QString());
+}
 
 void TestCore::serialization()
 {
@@ -65,4 +247,1341 @@ void TestCore::serialization()
 	// TODO compare sidRead with sid
 }
 
-QTEST_MAIN(TestCore)
\ No newline at end of file
+void TestCore::contentVisibility()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 10; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, (i % 3 == 0) ? ADS_NS::RightDropArea : ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	foreach (const ADS_NS::SectionContent::RefPtr& sc, contents)
+	{
+		QVERIFY(cw.isSectionContentVisible(sc));
+	}
+
+	// Hide every content, which also deletes the emptied sections.
+	foreach (const ADS_NS::SectionContent::RefPtr& sc, contents)
+	{
+		QVERIFY(cw.hideSectionContent(sc));
+		QVERIFY(!cw.isSectionContentVisible(sc));
+		QVERIFY(cw.hideSectionContent(sc));
+	}
+
+	// Show them again in reverse order.
+	for (int i = contents.count() - 1; i >= 0; --i)
+	{
+		QVERIFY(cw.showSectionContent(contents.at(i)));
+		QVERIFY(cw.isSectionContentVisible(contents.at(i)));
+		QVERIFY(cw.raiseSectionContent(contents.at(i)));
+	}
+
+	QVERIFY(cw.removeSectionContent(contents.first()));
+	QVERIFY(!cw.isSectionContentVisible(contents.first()));
+}
+
+void TestCore::batchedUpdates()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+	for (int i = 0; i < 4; ++i)
+		contents.append(ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content")));
+
+	// "uname-0" and "uname-3" share a section, "uname-1" and "uname-2" are stacked in a nested splitter.
+	ADS_NS::SectionWidget* swA = cw.addSectionContent(contents.at(0));
+	cw.addSectionContent(contents.at(3), swA, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* swB = cw.addSectionContent(contents.at(1), swA, ADS_NS::RightDropArea);
+	ADS_NS::SectionWidget* swC = cw.addSectionContent(contents.at(2), swB, ADS_NS::BottomDropArea);
+	QPointer<QSplitter> nested = qobject_cast<QSplitter*>(swC->parentWidget());
+	QVERIFY(nested);
+	QVERIFY(nested != swA->parentWidget());
+
+	VisibilityChangedRecorder recorder;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	QObject::connect(&cw, &ADS_NS::ContainerWidget::sectionContentVisibilityChanged, &recorder, &VisibilityChangedRecorder::onSectionContentVisibilityChanged);
+#else
+	QObject::connect(&cw, SIGNAL(sectionContentVisibilityChanged(SectionContent::RefPtr,bool)), &recorder, SLOT(onSectionContentVisibilityChanged(ADS_NS::SectionContent::RefPtr,bool)));
+#endif
+
+	// Nested pairs, only the outermost endUpdate() commits.
+	cw.beginUpdate();
+	cw.beginUpdate();
+	QVERIFY(cw.isUpdating());
+	QVERIFY(cw.hideSectionContent(contents.at(1)));
+	QVERIFY(cw.hideSectionContent(contents.at(2)));
+	cw.endUpdate();
+	QVERIFY(cw.isUpdating());
+	QVERIFY(nested);
+	QCOMPARE(nested->count(), 0);
+	QVERIFY(recorder.emissions.isEmpty());
+	cw.endUpdate();
+	QVERIFY(!cw.isUpdating());
+	QVERIFY(!nested);
+	QCOMPARE(recorder.emissions.count(), 2);
+
+	// Several toggles of a content deliver a single signal with the final state.
+	recorder.emissions.clear();
+	cw.beginUpdate();
+	QVERIFY(cw.hideSectionContent(contents.at(3)));
+	QVERIFY(cw.showSectionContent(contents.at(3)));
+	QVERIFY(cw.hideSectionContent(contents.at(3)));
+	cw.endUpdate();
+	QCOMPARE(recorder.emissions.count(), 1);
+	QCOMPARE(recorder.emissions.first(), qMakePair(QString("uname-3"), false));
+
+	// Back to the initial state, no signal at all.
+	recorder.emissions.clear();
+	cw.beginUpdate();
+	QVERIFY(cw.showSectionContent(contents.at(3)));
+	QVERIFY(cw.hideSectionContent(contents.at(3)));
+	cw.endUpdate();
+	QVERIFY(recorder.emissions.isEmpty());
+	QVERIFY(!cw.isSectionContentVisible(contents.at(3)));
+}
+
+void TestCore::layoutTree()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 6; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, (i % 2 == 0) ? ADS_NS::BottomDropArea : ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	ADS_NS::DockLayoutTree tree = cw.layoutTree();
+	QVERIFY(tree.root.type == ADS_NS::DockLayoutNode::SplitterNode);
+	QCOMPARE(tree.root.sectionCount(), 3);
+	QVERIFY(tree.hiddenContents.isEmpty());
+
+	// Hidden contents stay associated with their section.
+	QVERIFY(cw.hideSectionContent(contents.at(1)));
+	tree = cw.layoutTree();
+	QCOMPARE(tree.root.sectionCount(), 3);
+	QVERIFY(tree.hiddenContents.isEmpty());
+
+	// The tree writes the same data as saveState() does.
+	ADS_NS::DockLayoutTree stateTree;
+	QVERIFY(stateTree.fromState(cw.saveState()));
+	QVERIFY(stateTree == tree);
+
+	// Round trip
+	ADS_NS::DockLayoutTree readTree;
+	QVERIFY(readTree.fromByteArray(tree.toByteArray()));
+	QVERIFY(readTree == tree);
+	QVERIFY(readTree.toByteArray() == tree.toByteArray());
+
+	// Without any section, all hidden contents are written as plain list.
+	foreach (const ADS_NS::SectionContent::RefPtr& sc, contents)
+	{
+		QVERIFY(cw.hideSectionContent(sc));
+	}
+	tree = cw.layoutTree();
+	QVERIFY(!tree.root.isValid());
+	QCOMPARE(tree.hiddenContents.count(), contents.count());
+	QVERIFY(readTree.fromByteArray(tree.toByteArray()));
+	QVERIFY(readTree == tree);
+}
+
+void TestCore::incrementalRestore()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 9; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, (i % 3 == 0) ? ADS_NS::RightDropArea : ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+	QVERIFY(cw.hideSectionContent(contents.at(4)));
+	QVERIFY(cw.raiseSectionContent(contents.at(7)));
+
+	QList<int> sectionIds;
+	ADS_NS::DockLayoutTree tree = cw.layoutTree();
+	stripLayoutNode(tree.root, sectionIds);
+	const QByteArray state = cw.saveState();
+
+	// Unchanged layout, all sections are reused.
+	QVERIFY(cw.restoreState(state, ADS_NS::ContainerWidget::IncrementalRestore));
+	QList<int> restoredIds;
+	ADS_NS::DockLayoutTree restored = cw.layoutTree();
+	stripLayoutNode(restored.root, restoredIds);
+	QVERIFY(restored == tree);
+	QVERIFY(restoredIds == sectionIds);
+
+	// Change the layout and restore it again.
+	QVERIFY(cw.hideSectionContent(contents.at(0)));
+	QVERIFY(cw.hideSectionContent(contents.at(1)));
+	QVERIFY(cw.hideSectionContent(contents.at(2)));
+	QVERIFY(cw.showSectionContent(contents.at(4)));
+	cw.addSectionContent(ADS_NS::SectionContent::newSectionContent("uname-new", &cw, new QLabel("Title"), new QLabel("Content")), NULL, ADS_NS::BottomDropArea);
+
+	QVERIFY(cw.restoreState(state, ADS_NS::ContainerWidget::IncrementalRestore));
+	restoredIds.clear();
+	restored = cw.layoutTree();
+	stripLayoutNode(restored.root, restoredIds);
+	QCOMPARE(restored.root.sectionCount(), tree.root.sectionCount());
+	QVERIFY(restored.root.children.mid(1) == tree.root.children.mid(1));
+	QVERIFY(restoredIds.mid(1) == sectionIds.mid(1));
+	foreach (const ADS_NS::SectionContent::RefPtr& sc, contents)
+	{
+		QCOMPARE(cw.isSectionContentVisible(sc), sc != contents.at(4));
+	}
+}
+
+void TestCore::lazyContentWidget()
+{
+	ADS_NS::ContainerWidget cw;
+	QSharedPointer<CountingContentFactory> factory(new CountingContentFactory());
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 10; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), factory);
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	// Nothing has been shown yet.
+	QCOMPARE(factory->created, 0);
+	QVERIFY(cw.hideSectionContent(contents.at(0)));
+	QVERIFY(cw.showSectionContent(contents.at(0)));
+	QVERIFY(cw.raiseSectionContent(contents.at(1)));
+	QCOMPARE(factory->created, 0);
+
+	// Explicit request
+	QWidget* w = contents.at(2)->contentWidget();
+	QVERIFY(w != NULL);
+	QVERIFY(contents.at(2)->isContentWidgetLoaded());
+	QVERIFY(!contents.at(3)->isContentWidgetLoaded());
+	QVERIFY(contents.at(2)->contentWidget() == w);
+	QCOMPARE(factory->created, 1);
+
+	// The widget is part of the section, instead of being a top level window.
+	QVERIFY(w->parentWidget() != NULL);
+
+	QVERIFY(cw.removeSectionContent(contents.at(4)));
+	QCOMPARE(factory->created, 1);
+}
+
+void TestCore::contentHibernation()
+{
+	ADS_NS::ContainerWidget cw;
+	QSharedPointer<CountingContentFactory> factory(new CountingContentFactory());
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 5; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), factory);
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	// Without policy, nothing gets unloaded.
+	for (int i = 0; i < contents.count(); ++i)
+		QVERIFY(contents.at(i)->contentWidget() != NULL);
+	QCOMPARE(factory->created, 5);
+
+	// Only the two most recently used contents stay loaded.
+	cw.setHibernationPolicy(0, 2);
+	for (int i = 0; i < 3; ++i)
+		QVERIFY(!contents.at(i)->isContentWidgetLoaded());
+	QVERIFY(contents.at(3)->isContentWidgetLoaded());
+	QVERIFY(contents.at(4)->isContentWidgetLoaded());
+
+	// Recreated with its previous state
+	static_cast<QLabel*>(contents.at(3)->contentWidget())->setText("changed");
+	QVERIFY(cw.hibernateSectionContent(contents.at(3)));
+	QVERIFY(!contents.at(3)->isContentWidgetLoaded());
+	QLabel* label = static_cast<QLabel*>(contents.at(3)->contentWidget());
+	QCOMPARE(label->text(), QString("changed"));
+	QCOMPARE(factory->created, 6);
+	QVERIFY(contents.at(4)->isContentWidgetLoaded());
+
+	// Inactive contents get unloaded after the timeout.
+	cw.setHibernationPolicy(10, 0);
+	QTest::qWait(100);
+	for (int i = 0; i < contents.count(); ++i)
+		QVERIFY(!contents.at(i)->isContentWidgetLoaded());
+}
+
+void TestCore::sectionContentsChanged()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 6; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	ContentsChangedRecorder recorder;
+	cw.setSectionContentsChangedEnabled(true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	QObject::connect(&cw, &ADS_NS::ContainerWidget::sectionContentsChanged, &recorder, &ContentsChangedRecorder::onSectionContentsChanged);
+#else
+	QObject::connect(&cw, SIGNAL(sectionContentsChanged(QList<SectionContentChange>)), &recorder, SLOT(onSectionContentsChanged(QList<SectionContentChange>)));
+#endif
+
+	// A batch delivers a single signal at its end.
+	cw.beginUpdate();
+	QVERIFY(cw.hideSectionContent(contents.at(0)));
+	QVERIFY(cw.hideSectionContent(contents.at(1)));
+	QVERIFY(cw.hideSectionContent(contents.at(2)));
+	QVERIFY(cw.showSectionContent(contents.at(0)));
+	QVERIFY(cw.raiseSectionContent(contents.at(4)));
+	QCOMPARE(recorder.emissions.count(), 0);
+	cw.endUpdate();
+	QCOMPARE(recorder.emissions.count(), 1);
+
+	QStringList hidden;
+	foreach (const ADS_NS::SectionContentChange& c, recorder.emissions.first())
+	{
+		QVERIFY(c.visible != c.visibleBefore || c.active != c.activeBefore);
+		if (c.visibleBefore && !c.visible)
+			hidden.append(c.content->uniqueName());
+	}
+	hidden.sort();
+	QCOMPARE(hidden, QStringList() << "uname-1" << "uname-2");
+
+	// Without batch, changes are delivered once per event loop iteration.
+	recorder.emissions.clear();
+	QVERIFY(cw.raiseSectionContent(contents.at(5)));
+	QVERIFY(cw.raiseSectionContent(contents.at(3)));
+	QCOMPARE(recorder.emissions.count(), 0);
+	QCoreApplication::processEvents();
+	QCOMPARE(recorder.emissions.count(), 1);
+
+	// "uname-5" got active and inactive again.
+	QStringList changed;
+	foreach (const ADS_NS::SectionContentChange& c, recorder.emissions.first())
+		changed.append(c.content->uniqueName());
+	changed.sort();
+	QCOMPARE(changed, QStringList() << "uname-3" << "uname-4");
+}
+
+// Compares the section geometries of DockLayoutGeometry with the real widgets, returns false on the first mismatch.
+// Run with "-platform offscreen" on machines without display.
+static bool compareLayoutGeometry(ADS_NS::ContainerWidget& cw, const ADS_NS::DockLayoutNode& root)
+{
+	QSplitter* splitter = cw.findChild<QSplitter*>();
+	if (!splitter)
+	{
+		qWarning("No splitter");
+		return false;
+	}
+
+	QHash<int, ADS_NS::SectionWidget*> sections;
+	QSize minimumSectionSize;
+	foreach (ADS_NS::SectionWidget* sw, cw.findChildren<ADS_NS::SectionWidget*>())
+	{
+		sections.insert(sw->uid(), sw);
+		minimumSectionSize = sw->minimumSizeHint().expandedTo(sw->minimumSize());
+	}
+
+	ADS_NS::DockLayoutNode idNode = cw.layoutTree().root;
+	QList<int> sectionIds;
+	stripLayoutNode(idNode, sectionIds);
+
+	const QList<QRect> rects = ADS_NS::DockLayoutGeometry::sectionGeometries(root, splitter->contentsRect(), splitter->handleWidth(), minimumSectionSize);
+	if (rects.count() != sectionIds.count())
+	{
+		qWarning() << "Section count, computed:" << rects.count() << "actual:" << sectionIds.count();
+		return false;
+	}
+	for (int i = 0; i < rects.count(); ++i)
+	{
+		ADS_NS::SectionWidget* sw = sections.value(sectionIds.at(i));
+		if (!sw)
+		{
+			qWarning() << "Unknown section id:" << sectionIds.at(i);
+			return false;
+		}
+		const QRect actual(sw->mapTo(splitter, QPoint(0, 0)), sw->size());
+		if (rects.at(i) != actual)
+		{
+			qWarning() << "Section" << i << "computed:" << rects.at(i) << "actual:" << actual;
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestCore::layoutGeometry()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	const ADS_NS::DropArea areas[] = { ADS_NS::CenterDropArea, ADS_NS::RightDropArea, ADS_NS::BottomDropArea, ADS_NS::CenterDropArea, ADS_NS::RightDropArea, ADS_NS::LeftDropArea, ADS_NS::BottomDropArea };
+	for (int i = 0; i < 7; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, areas[i]);
+		contents.append(sc);
+	}
+
+	cw.resize(800, 600);
+	QVERIFY(showAndWait(cw));
+	QCoreApplication::processEvents();
+
+	// Current layout
+	const QByteArray state = cw.saveState();
+	ADS_NS::DockLayoutTree tree;
+	QVERIFY(tree.fromState(state));
+	QVERIFY(compareLayoutGeometry(cw, tree.root));
+
+	// The stored sizes are distributed over a different size.
+	cw.resize(1100, 450);
+	QCoreApplication::processEvents();
+	QVERIFY(compareLayoutGeometry(cw, tree.root));
+
+	// Restored layout
+	QVERIFY(cw.restoreState(state));
+	QCoreApplication::processEvents();
+	QVERIFY(compareLayoutGeometry(cw, tree.root));
+
+	// The container can not get smaller than its minimum size, which is the sum of the section minimums.
+	cw.resize(120, 90);
+	QCoreApplication::processEvents();
+	QVERIFY(compareLayoutGeometry(cw, tree.root));
+}
+
+static int visibleTitleWidgetCount(ADS_NS::ContainerWidget& cw)
+{
+	int count = 0;
+	foreach (ADS_NS::SectionTitleWidget* stw, cw.findChildren<ADS_NS::SectionTitleWidget*>())
+	{
+		if (stw->isVisible())
+			++count;
+	}
+	return count;
+}
+
+void TestCore::virtualTabs()
+{
+	ADS_NS::ContainerWidget cw;
+	cw.setVirtualTabsEnabled(true);
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	cw.beginUpdate();
+	for (int i = 0; i < 300; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+	cw.endUpdate();
+
+	cw.resize(800, 600);
+	QVERIFY(showAndWait(cw));
+
+	// Only the title widget of the current tab is shown.
+	QCOMPARE(sw->currentIndex(), 0);
+	QCOMPARE(visibleTitleWidgetCount(cw), 1);
+
+	QVERIFY(cw.raiseSectionContent(contents.at(250)));
+	QCOMPARE(sw->currentIndex(), 250);
+	QCOMPARE(visibleTitleWidgetCount(cw), 1);
+	int activeCount = 0;
+	foreach (ADS_NS::SectionTitleWidget* stw, cw.findChildren<ADS_NS::SectionTitleWidget*>())
+	{
+		if (stw->isActiveTab())
+			++activeCount;
+	}
+	QCOMPARE(activeCount, 1);
+
+	// Hit testing works on the painted tabs.
+	ADS_NS::SectionTabStrip* strip = sw->findChild<ADS_NS::SectionTabStrip*>();
+	QVERIFY(strip != NULL);
+	QCOMPARE(strip->count(), 300);
+	for (int i = 0; i < 300; i += 37)
+	{
+		QCOMPARE(strip->tabAt(strip->tabRect(i).center()), i);
+		QCOMPARE(strip->tabAt(strip->tabRect(i).topLeft()), i);
+	}
+	QCOMPARE(strip->tabAt(QPoint(-1, 0)), -1);
+
+	// Moving and hiding keeps the strip in sync.
+	sw->moveContent(250, 0);
+	QCOMPARE(sw->indexOfContent(contents.at(250)), 0);
+	QVERIFY(strip->tabRect(1).left() == strip->tabRect(0).right() + 1);
+	QVERIFY(cw.hideSectionContent(contents.at(10)));
+	QCOMPARE(strip->count(), 299);
+	QVERIFY(cw.showSectionContent(contents.at(10)));
+	QCOMPARE(strip->count(), 300);
+	QVERIFY(visibleTitleWidgetCount(cw) <= 2);
+
+	// A press on a painted tab without a hover move before activates it.
+	const int current = sw->currentIndex();
+	const int pressed = current == 1 ? 2 : 1;
+	sendMouseEvent(strip, QEvent::MouseButtonPress, strip->mapToGlobal(strip->tabRect(pressed).center()), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(strip, QEvent::MouseButtonRelease, strip->mapToGlobal(strip->tabRect(pressed).center()), Qt::LeftButton, Qt::NoButton);
+	QCOMPARE(sw->currentIndex(), pressed);
+}
+
+void TestCore::tabsMenu()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 200; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+	sw->moveContent(199, 0);
+
+	// No entries until the menu shows up.
+	QMenu* menu = sw->findChild<QMenu*>();
+	QVERIFY(menu != NULL);
+	QVERIFY(menu->actions().isEmpty());
+
+	QVERIFY(QMetaObject::invokeMethod(menu, "aboutToShow"));
+	QCOMPARE(menu->actions().count(), 200);
+	QCOMPARE(menu->actions().first()->data().toInt(), contents.at(199)->uid());
+
+	menu->actions().at(50)->trigger();
+	QCOMPARE(sw->currentIndex(), 50);
+
+	// Changes are applied on next show.
+	QVERIFY(cw.hideSectionContent(contents.at(10)));
+	QCOMPARE(menu->actions().count(), 200);
+	QVERIFY(QMetaObject::invokeMethod(menu, "aboutToShow"));
+	QCOMPARE(menu->actions().count(), 199);
+}
+
+static QList<ADS_NS::SectionTitleWidget*> activeTitleWidgets(ADS_NS::ContainerWidget& cw)
+{
+	QList<ADS_NS::SectionTitleWidget*> titles;
+	foreach (ADS_NS::SectionTitleWidget* stw, cw.findChildren<ADS_NS::SectionTitleWidget*>())
+	{
+		if (stw->isActiveTab())
+			titles.append(stw);
+	}
+	return titles;
+}
+
+void TestCore::tabSwitching()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 100; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+
+	// Exactly one title is active after each switch.
+	for (int i = 0; i < 100; ++i)
+	{
+		const int index = (i * 37) % 100;
+		sw->setCurrentIndex(index);
+		QCOMPARE(sw->currentIndex(), index);
+		const QList<ADS_NS::SectionTitleWidget*> titles = activeTitleWidgets(cw);
+		QCOMPARE(titles.count(), 1);
+		QVERIFY(sw->contents().at(index)->titleWidget()->parentWidget() == titles.first());
+	}
+
+	// Moved and re-added tabs.
+	sw->setCurrentIndex(5);
+	sw->moveContent(5, 80);
+	sw->setCurrentIndex(3);
+	QCOMPARE(activeTitleWidgets(cw).count(), 1);
+	QVERIFY(cw.hideSectionContent(contents.at(3)));
+	QVERIFY(cw.showSectionContent(contents.at(3)));
+	QVERIFY(cw.raiseSectionContent(contents.at(3)));
+	QCOMPARE(activeTitleWidgets(cw).count(), 1);
+
+	// Palette based rendering of the active tab.
+	QPalette active = cw.palette();
+	active.setColor(QPalette::Window, Qt::red);
+	cw.setActiveTabPalettes(cw.palette(), active);
+	QCOMPARE(activeTitleWidgets(cw).first()->palette().color(QPalette::Window), QColor(Qt::red));
+	sw->setCurrentIndex(7);
+	QCOMPARE(activeTitleWidgets(cw).first()->palette().color(QPalette::Window), QColor(Qt::red));
+	QCOMPARE(sw->contents().at(3)->titleWidget()->palette().color(QPalette::Window), cw.palette().color(QPalette::Window));
+}
+
+void TestCore::tabHitTesting()
+{
+	ADS_NS::ContainerWidget cw;
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 8; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel(QString("Title %1").arg(i)), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+	cw.resize(1200, 600);
+	QVERIFY(showAndWait(cw));
+
+	for (int i = 0; i < contents.count(); ++i)
+	{
+		QWidget* title = contents.at(i)->titleWidget()->parentWidget();
+		const QPoint center = title->mapTo(sw, title->rect().center());
+		QCOMPARE(sw->indexOfContentByTitlePos(center), i);
+		QCOMPARE(sw->indexOfContentByTitlePos(center, title), -1);
+	}
+
+	// The slots follow the relayout after a move.
+	sw->moveContent(0, 7);
+	QCoreApplication::processEvents();
+	QWidget* title = contents.at(0)->titleWidget()->parentWidget();
+	QCOMPARE(sw->indexOfContentByTitlePos(title->mapTo(sw, title->rect().center())), 7);
+
+	// Free space behind the last tab.
+	QCOMPARE(sw->indexOfContentByTitlePos(QPoint(sw->width() - 60, title->mapTo(sw, QPoint()).y() + 1)), -1);
+}
+
+void TestCore::sectionAt()
+{
+	ADS_NS::ContainerWidget cw;
+	createSectionGrid(cw, 4, 4);
+	cw.resize(800, 600);
+	QVERIFY(showAndWait(cw));
+
+	const QList<ADS_NS::SectionWidget*> sections = cw.findChildren<ADS_NS::SectionWidget*>();
+	for (int y = 0; y < cw.height(); y += 7)
+	{
+		for (int x = 0; x < cw.width(); x += 7)
+			QVERIFY(cw.sectionAt(QPoint(x, y)) == legacySectionAt(&cw, sections, QPoint(x, y)));
+	}
+
+	// The index follows geometry changes.
+	QSplitter* splitter = cw.findChild<QSplitter*>();
+	QList<int> sizes = splitter->sizes();
+	sizes[0] += sizes[1] / 2;
+	sizes[1] -= sizes[1] / 2;
+	splitter->setSizes(sizes);
+	cw.resize(900, 500);
+	QCoreApplication::processEvents();
+	for (int y = 0; y < cw.height(); y += 7)
+	{
+		for (int x = 0; x < cw.width(); x += 7)
+			QVERIFY(cw.sectionAt(QPoint(x, y)) == legacySectionAt(&cw, sections, QPoint(x, y)));
+	}
+}
+
+void TestCore::dropAreaAt()
+{
+	QWidget target;
+	target.resize(400, 300);
+	QVERIFY(showAndWait(target));
+
+	ADS_NS::DropOverlay overlay(&target);
+	overlay.setAllowedAreas(ADS_NS::AllAreas);
+
+	// Nothing to hit while hidden.
+	const QPoint center = target.mapToGlobal(target.rect().center());
+	QCOMPARE(overlay.dropAreaAt(center), ADS_NS::InvalidDropArea);
+
+	QCOMPARE(overlay.showDropOverlay(&target, center), ADS_NS::CenterDropArea);
+	QCOMPARE(overlay.dropAreaAt(center), ADS_NS::CenterDropArea);
+	QCOMPARE(overlay.showDropOverlay(&target, target.mapToGlobal(QPoint(1, 1))), ADS_NS::InvalidDropArea);
+
+	// Areas which are not allowed are not hit.
+	overlay.setAllowedAreas(ADS_NS::TopDropArea);
+	QCoreApplication::processEvents();
+	QCOMPARE(overlay.dropAreaAt(center), ADS_NS::InvalidDropArea);
+
+	overlay.hideDropOverlay();
+	QCOMPARE(overlay.dropAreaAt(center), ADS_NS::InvalidDropArea);
+}
+
+// QLabel::pixmap() returns a pointer before Qt 5.15.
+static qint64 pixmapCacheKey(const QLabel* label)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+	return label->pixmap(Qt::ReturnByValue).cacheKey();
+#else
+	return label->pixmap()->cacheKey();
+#endif
+}
+
+void TestCore::dropIndicatorPixmaps()
+{
+	QWidget parent;
+	ADS_NS::DropOverlay overlay1(&parent);
+	ADS_NS::DropOverlay overlay2(&parent);
+
+	// Both overlays share the pixmaps of the 5 areas.
+	const QList<QLabel*> labels = parent.findChildren<QLabel*>("DropAreaLabel");
+	QCOMPARE(labels.count(), 10);
+	QSet<qint64> keys;
+	for (int i = 0; i < labels.count(); ++i)
+		keys.insert(pixmapCacheKey(labels.at(i)));
+	QCOMPARE(keys.count(), 5);
+
+	// A new palette results in a new pixmap.
+	QLabel* label = labels.first();
+	const qint64 oldKey = pixmapCacheKey(label);
+	QPalette pal = label->palette();
+	pal.setColor(QPalette::Highlight, Qt::red);
+	label->setPalette(pal);
+	QVERIFY(pixmapCacheKey(label) != oldKey);
+	QVERIFY(!keys.contains(pixmapCacheKey(label)));
+}
+
+void TestCore::dropOverlayTargets()
+{
+	QWidget window;
+	window.resize(600, 300);
+	QWidget* left = new QWidget(&window);
+	left->setGeometry(0, 0, 300, 300);
+	QWidget* right = new QWidget(&window);
+	right->setGeometry(300, 0, 300, 300);
+	QVERIFY(showAndWait(window));
+
+	ADS_NS::DropOverlay overlay(&window);
+	overlay.setAllowedAreas(ADS_NS::AllAreas);
+	ShowHideCounter counter;
+	overlay.installEventFilter(&counter);
+
+	const QPoint leftCenter = left->mapToGlobal(left->rect().center());
+	const QPoint rightCenter = right->mapToGlobal(right->rect().center());
+	QCOMPARE(overlay.showDropOverlay(left, leftCenter), ADS_NS::CenterDropArea);
+
+	// Switching targets moves the overlay, it stays mapped.
+	QCOMPARE(overlay.showDropOverlay(right, rightCenter), ADS_NS::CenterDropArea);
+	QCOMPARE(overlay.geometry(), QRect(right->mapToGlobal(QPoint(0, 0)), right->size()));
+	overlay.showDropOverlay(&window, QRect(0, 0, 600, 20));
+	QCOMPARE(overlay.geometry(), QRect(window.mapToGlobal(QPoint(0, 0)), QSize(600, 20)));
+	QCOMPARE(overlay.showDropOverlay(left, leftCenter), ADS_NS::CenterDropArea);
+	QVERIFY(overlay.isVisible());
+	QCOMPARE(counter.shown, 1);
+	QCOMPARE(counter.hidden, 0);
+
+	overlay.hideDropOverlay();
+	QCOMPARE(counter.hidden, 1);
+}
+
+void TestCore::dropOverlayChildMode()
+{
+	QWidget window;
+	window.resize(600, 300);
+	QWidget* left = new QWidget(&window);
+	left->setGeometry(0, 0, 300, 300);
+	QWidget* right = new QWidget(&window);
+	right->setGeometry(300, 0, 300, 300);
+	QVERIFY(showAndWait(window));
+
+	ADS_NS::DropOverlay overlay(&window);
+	overlay.setMode(ADS_NS::DropOverlay::ChildMode);
+	overlay.setAllowedAreas(ADS_NS::AllAreas);
+
+	QCOMPARE(overlay.showDropOverlay(right, right->mapToGlobal(right->rect().center())), ADS_NS::CenterDropArea);
+	QVERIFY(!overlay.isWindow());
+	QVERIFY(overlay.isVisible());
+	QCOMPARE(overlay.geometry(), right->geometry());
+	QCOMPARE(overlay.showDropOverlay(right, right->mapToGlobal(QPoint(1, 1))), ADS_NS::InvalidDropArea);
+
+	overlay.showDropOverlay(&window, QRect(0, 280, 600, 20));
+	QCOMPARE(overlay.geometry(), QRect(0, 280, 600, 20));
+
+	// Targets in other windows are rejected.
+	QWidget other;
+	QCOMPARE(overlay.showDropOverlay(&other, QPoint()), ADS_NS::InvalidDropArea);
+	QVERIFY(!overlay.isVisible());
+
+	overlay.setMode(ADS_NS::DropOverlay::TopLevelMode);
+	QVERIFY(overlay.isWindow());
+}
+
+void TestCore::outlineDrag()
+{
+	ADS_NS::ContainerWidget cw;
+	cw.setOutlineDragEnabled(true);
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionWidget* left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// The content stays in its section while the snapshot moves.
+	QWidget* title = sc1->titleWidget()->parentWidget();
+	const QPoint rightCenter = right->mapToGlobal(right->rect().center());
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, left->mapToGlobal(left->rect().center()), Qt::NoButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, rightCenter, Qt::NoButton, Qt::LeftButton);
+	QVERIFY(cw.findChild<QWidget*>("DragPreview") != NULL);
+	QVERIFY(left->contents().contains(sc1));
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+
+	// Moved once on release.
+	sendMouseEvent(title, QEvent::MouseButtonRelease, rightCenter, Qt::LeftButton, Qt::NoButton);
+	QVERIFY(cw.findChild<QWidget*>("DragPreview") == NULL);
+	QCOMPARE(right->contents().count(), 2);
+	QVERIFY(right->contents().contains(sc1));
+	QCOMPARE(left->contents().count(), 1);
+
+	// Released outside of any drop target, the content floats.
+	title = sc2->titleWidget()->parentWidget();
+	const QPoint outside = cw.mapToGlobal(QPoint(cw.width() + 100, cw.height() + 100));
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, outside, Qt::NoButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseButtonRelease, outside, Qt::LeftButton, Qt::NoButton);
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 1);
+	QVERIFY(sc2->contentWidget()->window() != &cw);
+	QCOMPARE(cw.findChildren<ADS_NS::SectionWidget*>().count(), 1);
+}
+
+void TestCore::floatingWidgetPool()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionWidget* left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	cw.setFloatingWidgetPoolSize(2);
+	QCOMPARE(cw.floatingWidgetPoolSize(), 2);
+	const QList<ADS_NS::FloatingWidget*> pool = cw.findChildren<ADS_NS::FloatingWidget*>();
+	QCOMPARE(pool.count(), 2);
+
+	// Tear off into a window of the pool.
+	const QPoint outside = cw.mapToGlobal(QPoint(cw.width() + 100, cw.height() + 100));
+	dragTitle(sc1, QList<QPoint>() << outside);
+	ADS_NS::FloatingWidget* fw = qobject_cast<ADS_NS::FloatingWidget*>(sc1->contentWidget()->window());
+	QVERIFY(fw != NULL);
+	QVERIFY(pool.contains(fw));
+	QVERIFY(fw->isVisible());
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 2);
+
+	// Dock back, the window returns to the pool.
+	const QPoint rightCenter = right->mapToGlobal(right->rect().center());
+	dragTitle(sc1, QList<QPoint>() << rightCenter);
+	QVERIFY(right->contents().contains(sc1));
+	QVERIFY(!fw->isVisible());
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 2);
+
+	// Removed floating contents return their window as well.
+	dragTitle(sc1, QList<QPoint>() << outside);
+	QVERIFY(cw.removeSectionContent(sc1));
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 2);
+
+	cw.setFloatingWidgetPoolSize(0);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+}
+
+void TestCore::tabbedFloatingWidget()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionWidget* left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// Two floating windows
+	dragTitle(sc1, QList<QPoint>() << cw.mapToGlobal(QPoint(cw.width() + 100, 0)));
+	dragTitle(sc2, QList<QPoint>() << cw.mapToGlobal(QPoint(0, cw.height() + 100)));
+	ADS_NS::FloatingWidget* fw = qobject_cast<ADS_NS::FloatingWidget*>(sc1->contentWidget()->window());
+	QVERIFY(fw != NULL);
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 2);
+
+	// Dropped onto the center of the other window, it becomes a tab.
+	const QPoint fwCenter = fw->mapToGlobal(fw->rect().center());
+	dragTitle(sc2, QList<QPoint>() << fwCenter);
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 1);
+	QVERIFY(fw->section() != NULL);
+	QCOMPARE(fw->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc1 << sc2);
+	QVERIFY(sc2->contentWidget()->window() == fw);
+
+	ADS_NS::DockLayoutTree tree = cw.layoutTree();
+	QCOMPARE(tree.floatings.count(), 1);
+	QCOMPARE(tree.floatings.first().tabs, QStringList() << "uname-1" << "uname-2");
+	QCOMPARE(tree.floatings.first().currentIndex, 1);
+	QCOMPARE(tree.root.sectionCount(), 1);
+
+	ADS_NS::DockLayoutTree readTree;
+	QVERIFY(readTree.fromByteArray(tree.toByteArray()));
+	QVERIFY(readTree == tree);
+
+	// Both restore modes recreate the tabbed window.
+	const QByteArray state = cw.saveState();
+	QVERIFY(cw.restoreState(state));
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 1);
+	QCOMPARE(cw.layoutTree().floatings.value(0).tabs, tree.floatings.first().tabs);
+	QCOMPARE(cw.layoutTree().floatings.value(0).currentIndex, 1);
+	QVERIFY(cw.restoreState(state, ADS_NS::ContainerWidget::IncrementalRestore));
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QCOMPARE(cw.findChildren<ADS_NS::FloatingWidget*>().count(), 1);
+	QCOMPARE(cw.layoutTree().floatings.value(0).tabs, tree.floatings.first().tabs);
+
+	// The window goes away with its last content.
+	fw = qobject_cast<ADS_NS::FloatingWidget*>(sc1->contentWidget()->window());
+	QVERIFY(fw != NULL && fw->section() != NULL);
+	QVERIFY(cw.hideSectionContent(sc1));
+	QVERIFY(cw.hideSectionContent(sc2));
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QVERIFY(cw.showSectionContent(sc1));
+	QVERIFY(cw.isSectionContentVisible(sc1));
+}
+
+void TestCore::tabStripDrag()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionContent::RefPtr sc4 = newNumberedContent(cw, 4);
+	ADS_NS::SectionWidget* left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	cw.addSectionContent(sc4, right, ADS_NS::CenterDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// The left half of a tab inserts in front of it, the marker shows the slot.
+	QWidget* title = sc1->titleWidget()->parentWidget();
+	QWidget* targetTitle = sc4->titleWidget()->parentWidget();
+	const QPoint targetPos = targetTitle->mapToGlobal(QPoint(2, targetTitle->height() / 2));
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, targetPos, Qt::NoButton, Qt::LeftButton);
+	QWidget* marker = right->findChild<QWidget*>("tabInsertMarker");
+	QVERIFY(marker != NULL);
+	QVERIFY(marker->isVisible());
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QVERIFY(left->contents().contains(sc1));
+
+	sendMouseEvent(title, QEvent::MouseButtonRelease, targetPos, Qt::LeftButton, Qt::NoButton);
+	QVERIFY(!marker->isVisible());
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3 << sc1 << sc4);
+	QCOMPARE(right->currentIndex(), 1);
+	QCOMPARE(left->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc2);
+
+	// Behind the last tab it is appended, the empty section goes away.
+	const QRect titleArea = right->titleAreaGeometry();
+	dragTitle(sc2, QList<QPoint>() << right->mapToGlobal(QPoint(titleArea.right() - 5, titleArea.center().y())));
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QCOMPARE(cw.findChildren<ADS_NS::SectionWidget*>().count(), 1);
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3 << sc1 << sc4 << sc2);
+}
+
+void TestCore::tabStripDragPath()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionContent::RefPtr sc4 = newNumberedContent(cw, 4);
+	QPointer<ADS_NS::SectionWidget> top = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, top, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, top, ADS_NS::RightDropArea);
+	ADS_NS::SectionWidget* bottom = cw.addSectionContent(sc4, top, ADS_NS::BottomDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// Across the splitter handle and just below the target title area, the drag stays pending.
+	QSplitter* root = qobject_cast<QSplitter*>(right->parentWidget());
+	QVERIFY(root != NULL);
+	const int titleY = top->mapTo(root, top->titleAreaGeometry().center()).y();
+	const QPoint handle = root->mapToGlobal(QPoint((root->widget(0)->geometry().right() + right->geometry().left()) / 2, titleY));
+	QRect titleArea = right->titleAreaGeometry();
+	const QPoint belowTitle = right->mapToGlobal(QPoint(titleArea.right() - 5, titleArea.bottom() + 2));
+	const QPoint rightTitle = right->mapToGlobal(QPoint(titleArea.right() - 5, titleArea.center().y()));
+	dragTitle(sc1, QList<QPoint>() << handle << belowTitle << rightTitle);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3 << sc1);
+	QCOMPARE(top->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc2);
+
+	// Over the content of its stacked section it floats, the tab strip below still takes it.
+	titleArea = bottom->titleAreaGeometry();
+	const QPoint bottomTitle = bottom->mapToGlobal(QPoint(titleArea.right() - 5, titleArea.center().y()));
+	dragTitle(sc2, QList<QPoint>() << top->mapToGlobal(top->rect().center()) << bottomTitle);
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	QVERIFY(top.isNull());
+	QCOMPARE(bottom->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc4 << sc2);
+	QVERIFY(sc2->contentWidget()->window() == &cw);
+}
+
+void TestCore::moveSection()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionContent::RefPtr sc4 = newNumberedContent(cw, 4);
+	QPointer<ADS_NS::SectionWidget> left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	left->setCurrentIndex(1);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// Same orientation, the section changes its place within the splitter.
+	QSplitter* root = qobject_cast<QSplitter*>(left->parentWidget());
+	QVERIFY(root != NULL);
+	QVERIFY(cw.moveSection(left, right, ADS_NS::RightDropArea));
+	QVERIFY(left->parentWidget() == root);
+	QCOMPARE(root->indexOf(right), 0);
+	QCOMPARE(root->indexOf(left), 1);
+	QCOMPARE(cw.findChildren<QSplitter*>().count(), 1);
+	QCOMPARE(left->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc1 << sc2);
+	QCOMPARE(left->currentIndex(), 1);
+
+	// Other orientation, a new splitter wraps both sections.
+	QVERIFY(cw.moveSection(left, right, ADS_NS::TopDropArea));
+	QSplitter* sp = qobject_cast<QSplitter*>(left->parentWidget());
+	QVERIFY(sp != NULL && sp != root);
+	QCOMPARE(sp->orientation(), Qt::Vertical);
+	QCOMPARE(sp->indexOf(left), 0);
+	QCOMPARE(sp->indexOf(right), 1);
+	QCOMPARE(left->currentIndex(), 1);
+
+	// Outer area
+	QVERIFY(cw.moveSection(left, NULL, ADS_NS::LeftDropArea));
+	QVERIFY(left->parentWidget() == root);
+	QCOMPARE(root->indexOf(left), 0);
+	QCOMPARE(cw.layoutTree().root.sectionCount(), 2);
+
+	// Center needs a section to merge into.
+	QVERIFY(!cw.moveSection(left, NULL, ADS_NS::CenterDropArea));
+	QVERIFY(left->parentWidget() == root);
+
+	// Center merges the tabs, the current tab stays current.
+	QVERIFY(cw.moveSection(left, right, ADS_NS::CenterDropArea));
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QVERIFY(left.isNull());
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3 << sc1 << sc2);
+	QCOMPARE(right->currentIndex(), 2);
+
+	// Dragged at the empty part of its tab strip onto the center of another section.
+	QPointer<ADS_NS::SectionWidget> other = cw.addSectionContent(sc4, right, ADS_NS::RightDropArea);
+	QWidget* tabs = other->findChild<QWidget*>("tabsContainerWidget");
+	QVERIFY(tabs != NULL);
+	const QPoint target = right->mapToGlobal(right->rect().center());
+	sendMouseEvent(tabs, QEvent::MouseButtonPress, tabs->mapToGlobal(QPoint(tabs->width() - 5, tabs->height() / 2)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(other, QEvent::MouseMove, target, Qt::NoButton, Qt::LeftButton);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	sendMouseEvent(other, QEvent::MouseButtonRelease, target, Qt::LeftButton, Qt::NoButton);
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QVERIFY(other.isNull());
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3 << sc1 << sc2 << sc4);
+	QCOMPARE(right->currentIndex(), 3);
+}
+
+void TestCore::deferredDetach()
+{
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	QPointer<ADS_NS::SectionWidget> left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc2, left, ADS_NS::RightDropArea);
+	cw.addSectionContent(sc3, right, ADS_NS::CenterDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	QSplitter* root = qobject_cast<QSplitter*>(left->parentWidget());
+	QVERIFY(root != NULL);
+	const QRect leftGeometry = left->geometry();
+	const QPoint outside = cw.mapToGlobal(QPoint(cw.width() + 100, cw.height() + 100));
+
+	// While dragging, the empty origin section keeps its place and shows a ghost tab.
+	QWidget* title = sc1->titleWidget()->parentWidget();
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, outside, Qt::NoButton, Qt::LeftButton);
+	QVERIFY(qobject_cast<ADS_NS::FloatingWidget*>(sc1->contentWidget()->window()) != NULL);
+	QVERIFY(!left.isNull());
+	QVERIFY(left->contents().isEmpty());
+	QVERIFY(left->parentWidget() == root);
+	QCOMPARE(left->geometry(), leftGeometry);
+	QLabel* ghost = left->findChild<QLabel*>("ghostTab");
+	QVERIFY(ghost != NULL);
+	QVERIFY(ghost->isVisible());
+
+	// Escape puts the content back into its slot.
+	QKeyEvent escape(QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier);
+	QApplication::sendEvent(title, &escape);
+	QVERIFY(escape.isAccepted());
+	QCOMPARE(left->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc1);
+	QVERIFY(sc1->contentWidget()->window() == &cw);
+	QVERIFY(!ghost->isVisible());
+	QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete);
+	QVERIFY(cw.findChildren<ADS_NS::FloatingWidget*>().isEmpty());
+	sendMouseEvent(title, QEvent::MouseButtonRelease, outside, Qt::LeftButton, Qt::NoButton);
+	QCOMPARE(left->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc1);
+
+	// A cancelled tab keeps its index in a section with other tabs.
+	title = sc2->titleWidget()->parentWidget();
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, outside, Qt::NoButton, Qt::LeftButton);
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc3);
+	QApplication::sendEvent(title, &escape);
+	sendMouseEvent(title, QEvent::MouseButtonRelease, outside, Qt::LeftButton, Qt::NoButton);
+	QCOMPARE(right->contents(), QList<ADS_NS::SectionContent::RefPtr>() << sc2 << sc3);
+
+	// The drop commits the move, the empty origin section goes away.
+	dragTitle(sc1, QList<QPoint>() << outside);
+	QVERIFY(left.isNull());
+	QCOMPARE(cw.findChildren<ADS_NS::SectionWidget*>().count(), 1);
+	ADS_NS::FloatingWidget* fw = qobject_cast<ADS_NS::FloatingWidget*>(sc1->contentWidget()->window());
+	QVERIFY(fw != NULL);
+
+	// Escape puts an existing floating window back, it does not follow the mouse anymore.
+	const QPoint fwPos = fw->pos();
+	title = sc1->titleWidget()->parentWidget();
+	sendMouseEvent(title, QEvent::MouseButtonPress, title->mapToGlobal(QPoint(5, 5)), Qt::LeftButton, Qt::LeftButton);
+	sendMouseEvent(title, QEvent::MouseMove, outside + QPoint(50, 50), Qt::NoButton, Qt::LeftButton);
+	QVERIFY(fw->pos() != fwPos);
+	QKeyEvent escapeMove(QEvent::KeyPress, Qt::Key_Escape, Qt::NoModifier);
+	QApplication::sendEvent(title, &escapeMove);
+	QVERIFY(escapeMove.isAccepted());
+	QCOMPARE(fw->pos(), fwPos);
+	sendMouseEvent(title, QEvent::MouseMove, outside + QPoint(80, 80), Qt::NoButton, Qt::LeftButton);
+	QCOMPARE(fw->pos(), fwPos);
+	sendMouseEvent(title, QEvent::MouseButtonRelease, right->mapToGlobal(right->rect().center()), Qt::LeftButton, Qt::NoButton);
+	QCOMPARE(fw->pos(), fwPos);
+	QVERIFY(sc1->contentWidget()->window() == fw);
+}
+
+void TestCore::benchmarkDeleteEmptySplitter_data()
+{
+	QTest::addColumn<int>("depth");
+	QTest::addColumn<bool>("leaf");
+	QTest::addColumn<bool>("legacy");
+
+	// "leaf" removes the innermost sections only, the way hide, move and drag-start do,
+	// otherwise all sections are gone and the whole tree has to be cleaned up.
+	const int depths[] = { 16, 64, 128 };
+	for (int i = 0; i < 3; ++i)
+	{
+		const int d = depths[i];
+		QTest::newRow(QString("depth %1, leaf, local").arg(d).toLatin1().constData()) << d << true << false;
+		QTest::newRow(QString("depth %1, leaf, rescan").arg(d).toLatin1().constData()) << d << true << true;
+		QTest::newRow(QString("depth %1, all, recursive").arg(d).toLatin1().constData()) << d << false << false;
+		QTest::newRow(QString("depth %1, all, rescan").arg(d).toLatin1().constData()) << d << false << true;
+	}
+}
+
+void TestCore::benchmarkDeleteEmptySplitter()
+{
+	QFETCH(int, depth);
+	QFETCH(bool, leaf);
+	QFETCH(bool, legacy);
+
+	// Alternating drop areas create a new nested splitter for every content.
+	ADS_NS::ContainerWidget cw;
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < depth; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, (i % 2) ? ADS_NS::RightDropArea : ADS_NS::BottomDropArea);
+	}
+
+	// Deleting the sections directly leaves the empty splitters behind, without any cleanup.
+	QPointer<QSplitter> innermost = qobject_cast<QSplitter*>(sw->parentWidget());
+	QVERIFY(innermost);
+	const int splitterCount = cw.findChildren<QSplitter*>().count();
+	QVERIFY(splitterCount >= depth / 2);
+	if (leaf)
+	{
+		QList<ADS_NS::SectionWidget*> sections;
+		for (int i = 0; i < innermost->count(); ++i)
+		{
+			ADS_NS::SectionWidget* section = qobject_cast<ADS_NS::SectionWidget*>(innermost->widget(i));
+			if (section)
+				sections.append(section);
+		}
+		QCOMPARE(sections.count(), innermost->count());
+		qDeleteAll(sections);
+	}
+	else
+		qDeleteAll(cw.findChildren<ADS_NS::SectionWidget*>());
+
+	// Time only the cleanup of the same tree.
+	QElapsedTimer timer;
+	timer.start();
+	if (legacy)
+		legacyDeleteEmptySplitter(&cw);
+	else if (leaf)
+		ADS_NS::deleteEmptySplitter(innermost.data());
+	else
+		ADS_NS::deleteEmptySplitter(&cw);
+	QTest::setBenchmarkResult(timer.nsecsElapsed() / 1000000.0, QTest::WalltimeMilliseconds);
+
+	QVERIFY(!innermost);
+	QCOMPARE(cw.findChildren<QSplitter*>().count(), leaf ? splitterCount - 1 : 0);
+}
+
+void TestCore::benchmarkActiveTabSwitch_data()
+{
+	QTest::addColumn<QString>("styleSheet");
+	QTest::addColumn<bool>("palettes");
+
+	// Palettes are ignored while a style sheet applies, style sheets only have repolish rows.
+	QTest::newRow("no style sheet, palettes") << QString() << true;
+	const QStringList styleSheets = QStringList() << "default-windows" << "modern-windows" << "vendor-partsolutions";
+	foreach (const QString& name, styleSheets)
+		QTest::newRow(QString("%1, repolish").arg(name).toLatin1().constData()) << name << false;
+}
+
+void TestCore::benchmarkActiveTabSwitch()
+{
+	QFETCH(QString, styleSheet);
+	QFETCH(bool, palettes);
+
+	if (!styleSheet.isEmpty())
+	{
+		QFile file(QString(":ads/stylesheets/%1.css").arg(styleSheet));
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		qApp->setStyleSheet(QString::fromUtf8(file.readAll()));
+	}
+
+	ADS_NS::ContainerWidget cw;
+	if (palettes)
+	{
+		QPalette active = cw.palette();
+		active.setColor(QPalette::Window, active.color(QPalette::Light));
+		cw.setActiveTabPalettes(cw.palette(), active);
+	}
+
+	QList<ADS_NS::SectionContent::RefPtr> contents;
+	ADS_NS::SectionWidget* sw = NULL;
+	for (int i = 0; i < 50; ++i)
+	{
+		ADS_NS::SectionContent::RefPtr sc = ADS_NS::SectionContent::newSectionContent(QString("uname-%1").arg(i), &cw, new QLabel("Title"), new QLabel("Content"));
+		sw = cw.addSectionContent(sc, sw, ADS_NS::CenterDropArea);
+		contents.append(sc);
+	}
+	cw.resize(800, 600);
+	QVERIFY(showAndWait(cw));
+
+	int index = 0;
+	QBENCHMARK
+	{
+		index = (index + 1) % 50;
+		sw->setCurrentIndex(index);
+	}
+	QCOMPARE(sw->currentIndex(), index);
+
+	// The same title has to look different as active and inactive tab.
+	QWidget* title = contents.at(index)->titleWidget()->parentWidget();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	const QImage activeImage = title->grab().toImage();
+	sw->setCurrentIndex((index + 1) % 50);
+	QVERIFY(title->grab().toImage() != activeImage);
+#else
+	const QImage activeImage = QPixmap::grabWidget(title).toImage();
+	sw->setCurrentIndex((index + 1) % 50);
+	QVERIFY(QPixmap::grabWidget(title).toImage() != activeImage);
+#endif
+}
+
+void TestCore::benchmarkSectionAt_data()
+{
+	QTest::addColumn<int>("size");
+	QTest::addColumn<bool>("legacy");
+
+	QTest::newRow("4x4, index") << 4 << false;
+	QTest::newRow("4x4, mapFromGlobal") << 4 << true;
+	QTest::newRow("8x8, index") << 8 << false;
+	QTest::newRow("8x8, mapFromGlobal") << 8 << true;
+}
+
+void TestCore::benchmarkSectionAt()
+{
+	QFETCH(int, size);
+	QFETCH(bool, legacy);
+
+	ADS_NS::ContainerWidget cw;
+	createSectionGrid(cw, size, size);
+	cw.resize(1600, 1200);
+	QVERIFY(showAndWait(cw));
+
+	// One lookup per simulated mouse move, diagonal through the container.
+	// The legacy lookup iterated a list of sections, which is collected only once.
+	const QList<ADS_NS::SectionWidget*> sections = cw.findChildren<ADS_NS::SectionWidget*>();
+	int found = 0;
+	QBENCHMARK
+	{
+		found = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			const QPoint pos(i * cw.width() / 1000, i * cw.height() / 1000);
+			if (legacy ? legacySectionAt(&cw, sections, pos) : cw.sectionAt(pos))
+				++found;
+		}
+	}
+	QVERIFY(found > 0);
+}
+
+void TestCore::benchmarkTearOff_data()
+{
+	QTest::addColumn<int>("poolSize");
+
+	QTest::newRow("new window") << 0;
+	QTest::newRow("pooled window") << 2;
+}
+
+void TestCore::benchmarkTearOff()
+{
+	QFETCH(int, poolSize);
+
+	ADS_NS::ContainerWidget cw;
+	cw.setFloatingWidgetPoolSize(poolSize);
+	ADS_NS::SectionContent::RefPtr sc1 = newNumberedContent(cw, 1);
+	ADS_NS::SectionContent::RefPtr sc2 = newNumberedContent(cw, 2);
+	ADS_NS::SectionContent::RefPtr sc3 = newNumberedContent(cw, 3);
+	ADS_NS::SectionWidget* left = cw.addSectionContent(sc1, NULL, ADS_NS::CenterDropArea);
+	cw.addSectionContent(sc2, left, ADS_NS::CenterDropArea);
+	ADS_NS::SectionWidget* right = cw.addSectionContent(sc3, left, ADS_NS::RightDropArea);
+	cw.resize(800, 400);
+	QVERIFY(showAndWait(cw));
+
+	// Tear off and dock back into the other section, forth and back.
+	const QPoint outside = cw.mapToGlobal(QPoint(cw.width() + 100, cw.height() + 100));
+	const QPoint leftCenter = left->mapToGlobal(left->rect().center());
+	const QPoint rightCenter = right->mapToGlobal(right->rect().center());
+	QBENCHMARK
+	{
+		dragTitle(sc1, QList<QPoint>() << outside);
+		dragTitle(sc1, QList<QPoint>() << rightCenter);
+		dragTitle(sc1, QList<QPoint>() << outside);
+		dragTitle(sc1, QList<QPoint>() << leftCenter);
+		QCoreApplication::sendPostedEvents(NULL, QEvent::DeferredDelete); // Windows outside of the pool
+	}
+	QVERIFY(left->contents().contains(sc1));
+}
+
+QTEST_MAIN(TestCore)
\ No newline at end of file
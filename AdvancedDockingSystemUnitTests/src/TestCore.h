@@ -3,12 +3,73 @@
 
 #include <QtTest/QtTest>
 
+#include "ads/ContainerWidget.h"
+
+// Records the sectionContentsChanged() signals of a ContainerWidget.
+class ContentsChangedRecorder : public QObject
+{
+	Q_OBJECT
+
+public slots:
+	void onSectionContentsChanged(const QList<ADS_NS::SectionContentChange>& changes) { emissions.append(changes); }
+
+public:
+	QList<QList<ADS_NS::SectionContentChange> > emissions;
+};
+
+// Records the sectionContentVisibilityChanged() signals of a ContainerWidget.
+class VisibilityChangedRecorder : public QObject
+{
+	Q_OBJECT
+
+public slots:
+	void onSectionContentVisibilityChanged(const ADS_NS::SectionContent::RefPtr& sc, bool visible) { emissions.append(qMakePair(sc->uniqueName(), visible)); }
+
+public:
+	QList<QPair<QString, bool> > emissions;
+};
+
 class TestCore : public QObject
 {
 	Q_OBJECT
 
 private slots:
+	void cleanup();
+
 	void serialization();
+	void contentVisibility();
+	void batchedUpdates();
+	void layoutTree();
+	void incrementalRestore();
+	void lazyContentWidget();
+	void contentHibernation();
+	void sectionContentsChanged();
+	void layoutGeometry();
+	void virtualTabs();
+	void tabsMenu();
+	void tabSwitching();
+	void tabHitTesting();
+	void sectionAt();
+	void dropAreaAt();
+	void dropIndicatorPixmaps();
+	void dropOverlayTargets();
+	void dropOverlayChildMode();
+	void outlineDrag();
+	void floatingWidgetPool();
+	void tabbedFloatingWidget();
+	void tabStripDrag();
+	void tabStripDragPath();
+	void moveSection();
+	void deferredDetach();
+
+	void benchmarkDeleteEmptySplitter_data();
+	void benchmarkDeleteEmptySplitter();
+	void benchmarkActiveTabSwitch_data();
+	void benchmarkActiveTabSwitch();
+	void benchmarkSectionAt_data();
+	void benchmarkSectionAt();
+	void benchmarkTearOff_data();
+	void benchmarkTearOff();
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file